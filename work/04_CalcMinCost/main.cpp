@@ -1,9 +1,13 @@
 #include <iostream>
 #include <vector>
 #include <tuple>
-#include <set>
-#include <queue>
+#include <limits>
 #include <algorithm>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <numeric>
 
 #include "../debug.hpp"
 #include "../Graph.hpp"
@@ -12,70 +16,325 @@ using namespace std;
 
 // clang-format off
 #define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+template<class T> bool chmax(T &a, const T &b) {if(a<b) {a=b; return true;} return false; }
 template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} return false; }
 template<class T> ostream& operator<<(ostream& os, vector<T>& vec){ rep(i, vec.size()) os << vec[i] << (i+1==(int)vec.size() ? "" : " "); return os;}
 // clang-format on
 
 using ll = long long;
-using Node = int;
 
-static constexpr int N = 4;
-static constexpr int M = 5;
+// 小さいケース(M <= 25程度)の最適スケジュールを分枝限定法で求める
+// - 目的関数: 各日の不満度(Graph::CalcCost)の総和
+// - 辺は単独で削除した時のコストの降順に工事日を決める
+// - 日のラベルの対称性: まだ使っていない日は最小のもの1つだけ試す
+// - 1日の工事件数がKを超える割り当ては試さない
+// - 下界: 各日の現在のコスト(辺を追加しても減少しない) + (残りの辺の単独コストの最大値 - 各日のコストの最大値)^+
+// - 探索木の上位の割り当て(prefix)をスレッドに分配する
+class BranchAndBound {
+  public:
+   BranchAndBound(const Graph& graph, int D, int K)
+       : graph_(graph), M_(graph.GetEdgeList().size()), D_(D), K_(K), best_cost_(numeric_limits<ll>::max()) {
+      rep(e, M_) {
+         edge_order_.emplace_back(e);
+      }
+
+      sort(edge_order_.begin(), edge_order_.end(), [&](int e1, int e2) {
+         return graph_.GetEdgeCost(e1).first > graph_.GetEdgeCost(e2).first;
+      });
 
-vector<int> edge_schedule(M);
-vector<int> best_edge_schedule(M);
-ll best_cost = numeric_limits<ll>::max();
+      // remain_max_cost_[i]: edge_order_[i]以降の辺の単独コストの最大値
+      remain_max_cost_.assign(M_ + 1, 0);
 
-ll CalcMinCost(Graph& graph, int D, int e) {
-   if (e == M) {
-      ll cost = 0;
+      for (int i = M_ - 1; i >= 0; i--) {
+         remain_max_cost_[i] = max(remain_max_cost_[i + 1], graph_.GetEdgeCost(edge_order_[i]).first);
+      }
+   }
 
-      rep(d, D) {
-         vector<int> edge_index_list;
+   // 最適なスケジュール(edge indexごとの工事日, 1-indexed)を返す
+   // 実行可能なスケジュールがない場合は空を返す
+   vector<int> Solve(int thread_num);
 
-         rep(i, M) {
-            if (edge_schedule[i] == d) {
-               edge_index_list.emplace_back(i);
-            }
-         }
+   ll GetBestCost() const {
+      return best_cost_;
+   }
+
+   ll GetNodeCount() const {
+      return node_count_;
+   }
+
+  protected:
+   // 探索の状態
+   struct State {
+      vector<int> day;                    // day[i]: edge_order_[i]の工事日(0-indexed)
+      vector<vector<int>> day_edge_list;  // 日ごとの工事辺
+      vector<ll> day_cost;                // 日ごとの不満度
+      int used_day = 0;                   // 使用済の日数(0..used_day-1が使用済)
+      ll node_count = 0;                  // 探索ノード数
+   };
+
+   // 下界を返す
+   ll LowerBound(const State& state, int i) const;
+
+   // edge_order_[i]をd日目に割り当てる/割り当てを戻す
+   void Assign(State& state, int i, int d) const;
+   void Unassign(State& state, int i, int d, ll prev_cost, int prev_used_day) const;
+
+   // edge_order_[i]以降の工事日を決める
+   void Search(State& state, int i);
+
+   // 上界を更新する
+   void UpdateBest(const State& state);
+
+   // Greedyに初期解を求める
+   void Greedy();
+
+   // 探索木の深さdepthまでの割り当てを列挙する
+   void EnumPrefix(State& state, int i, int depth, vector<vector<int>>& prefix_list) const;
+
+   const Graph& graph_;
+
+   int M_;  // 辺の数
+   int D_;  // スケジュール日数
+   int K_;  // 1日あたりの工事件数の上限
+
+   vector<int> edge_order_;      // 探索する辺の順序
+   vector<ll> remain_max_cost_;  // remain_max_cost_[i]: edge_order_[i]以降の辺の単独コストの最大値
+
+   atomic<ll> best_cost_;   // 最良解のコスト
+   vector<int> best_day_;   // 最良解(edge_order_順の工事日)
+   mutex best_mutex_;       // best_day_の更新用
+   atomic<ll> node_count_;  // 探索ノード数
+};
+
+ll BranchAndBound::LowerBound(const State& state, int i) const {
+   ll sum_cost = 0, max_cost = 0;
+
+   rep(d, D_) {
+      sum_cost += state.day_cost[d];
+      chmax(max_cost, state.day_cost[d]);
+   }
+
+   // 残りの辺のうち単独コストが最大の辺は、いずれかの日のコストをその値以上にする
+   return sum_cost + max(0LL, remain_max_cost_[i] - max_cost);
+}
+
+void BranchAndBound::Assign(State& state, int i, int d) const {
+   state.day[i] = d;
+   state.day_edge_list[d].emplace_back(edge_order_[i]);
+   state.day_cost[d] = graph_.CalcCost(state.day_edge_list[d]).first;
+   chmax(state.used_day, d + 1);
+}
+
+void BranchAndBound::Unassign(State& state, int i, int d, ll prev_cost, int prev_used_day) const {
+   state.day[i] = -1;
+   state.day_edge_list[d].pop_back();
+   state.day_cost[d] = prev_cost;
+   state.used_day = prev_used_day;
+}
+
+void BranchAndBound::Search(State& state, int i) {
+   state.node_count++;
+
+   if (LowerBound(state, i) >= best_cost_) return;
+
+   if (i == M_) {
+      UpdateBest(state);
+      return;
+   }
+
+   // 使用済の日と未使用の日のうち最小のもの(対称性の除去)
+   int day_limit = min(state.used_day + 1, D_);
+
+   rep(d, day_limit) {
+      if ((int)state.day_edge_list[d].size() >= K_) continue;
+
+      ll prev_cost = state.day_cost[d];
+      int prev_used_day = state.used_day;
+
+      Assign(state, i, d);
+      Search(state, i + 1);
+      Unassign(state, i, d, prev_cost, prev_used_day);
+   }
+}
+
+void BranchAndBound::UpdateBest(const State& state) {
+   ll cost = accumulate(state.day_cost.begin(), state.day_cost.end(), 0LL);
+
+   lock_guard<mutex> lock(best_mutex_);
+
+   if (cost < best_cost_) {
+      best_cost_ = cost;
+      best_day_ = state.day;
+   }
+}
+
+void BranchAndBound::Greedy() {
+   State state;
+   state.day.assign(M_, -1);
+   state.day_edge_list.assign(D_, vector<int>());
+   state.day_cost.assign(D_, 0);
+
+   // 増加量が最小の日に割り当てる
+   rep(i, M_) {
+      int best_d = -1;
+      ll best_diff = numeric_limits<ll>::max();
+
+      rep(d, D_) {
+         if ((int)state.day_edge_list[d].size() >= K_) continue;
 
-         cost += graph.CalcCost(edge_index_list).first;
+         ll prev_cost = state.day_cost[d];
+         int prev_used_day = state.used_day;
+
+         Assign(state, i, d);
+
+         if (chmin(best_diff, state.day_cost[d] - prev_cost)) best_d = d;
+
+         Unassign(state, i, d, prev_cost, prev_used_day);
       }
 
-      debug(cost, edge_schedule);
+      if (best_d == -1) return;
+      Assign(state, i, best_d);
+   }
+
+   UpdateBest(state);
+}
+
+void BranchAndBound::EnumPrefix(State& state, int i, int depth, vector<vector<int>>& prefix_list) const {
+   if (i == depth || i == M_) {
+      prefix_list.emplace_back(state.day.begin(), state.day.begin() + i);
+      return;
+   }
+
+   int day_limit = min(state.used_day + 1, D_);
+
+   rep(d, day_limit) {
+      if ((int)state.day_edge_list[d].size() >= K_) continue;
+
+      ll prev_cost = state.day_cost[d];
+      int prev_used_day = state.used_day;
+
+      // prefixの列挙ではコストを評価しない
+      state.day[i] = d;
+      state.day_edge_list[d].emplace_back(edge_order_[i]);
+      chmax(state.used_day, d + 1);
+
+      EnumPrefix(state, i + 1, depth, prefix_list);
+      Unassign(state, i, d, prev_cost, prev_used_day);
+   }
+}
+
+vector<int> BranchAndBound::Solve(int thread_num) {
+   node_count_ = 0;
+   Greedy();
+
+   // スレッド数に対して十分な数のprefixを作る
+   State init_state;
+   init_state.day.assign(M_, -1);
+   init_state.day_edge_list.assign(D_, vector<int>());
+   init_state.day_cost.assign(D_, 0);
+
+   vector<vector<int>> prefix_list;
+   int depth = 0;
+
+   while (depth < M_ && (int)prefix_list.size() < 8 * thread_num) {
+      depth++;
+      prefix_list.clear();
+      EnumPrefix(init_state, 0, depth, prefix_list);
+   }
+
+   atomic<int> next_prefix(0);
+
+   auto worker = [&]() {
+      State state;
+      state.day.assign(M_, -1);
+      state.day_edge_list.assign(D_, vector<int>());
+      state.day_cost.assign(D_, 0);
+
+      for (int p = next_prefix++; p < (int)prefix_list.size(); p = next_prefix++) {
+         const auto& prefix = prefix_list[p];
+         int L = prefix.size();
 
-      if (chmin(best_cost, cost)) {
-         best_edge_schedule = edge_schedule;
+         rep(i, L) {
+            Assign(state, i, prefix[i]);
+         }
+
+         Search(state, L);
+
+         for (int i = L - 1; i >= 0; i--) {
+            state.day[i] = -1;
+            state.day_edge_list[prefix[i]].pop_back();
+         }
+
+         state.day_cost.assign(D_, 0);
+         state.used_day = 0;
       }
 
-      return 0;
+      node_count_ += state.node_count;
+   };
+
+   vector<thread> thread_list;
+
+   rep(i, thread_num - 1) {
+      thread_list.emplace_back(worker);
    }
 
-   rep(d, D) {
-      edge_schedule[e] = d;
-      CalcMinCost(graph, D, e + 1);
+   worker();
+
+   for (auto& th : thread_list) {
+      th.join();
    }
 
-   return 0;
+   if (best_day_.empty()) return vector<int>();
+
+   vector<int> schedule(M_);
+
+   rep(i, M_) {
+      schedule[edge_order_[i]] = best_day_[i] + 1;
+   }
+
+   return schedule;
 }
 
-int main() {
-   // N: nodes, M: edges
-   using EdgeInfo = tuple<int, int, long long>;
-   vector<EdgeInfo> edge_list{{1, 2, 1}, {1, 3, 4}, {1, 4, 3}, {2, 4, 2}, {3, 4, 5}};
+// 使い方: ./main [スレッド数(default: 論理コア数)] < input
+int main(int argc, char* argv[]) {
+   int thread_num = argc > 1 ? stoi(argv[1]) : (int)thread::hardware_concurrency();
+   thread_num = max(1, thread_num);
+
+   int N, M, D, K;
+   cin >> N >> M >> D >> K;
 
    Graph graph(N);
 
-   for (auto [u, v, w] : edge_list) {
+   rep(e, M) {
+      int u, v, w;
+      cin >> u >> v >> w;
+
       graph.AddEdge(u, v, w);
    }
 
-   graph.Prep();
+   rep(i, N) {
+      int x, y;
+      cin >> x >> y;
+
+      graph.SetNodeCoord(i + 1, x, y);
+   }
+
+   // 下界に辺を1本削除した時のコストを使う
+   graph.Prep(false, true);
+
+   BranchAndBound solver(graph, D, K);
+   auto schedule = solver.Solve(thread_num);
+
+   if (schedule.empty()) {
+      cout << "No feasible schedule" << endl;
+      return 0;
+   }
 
-   CalcMinCost(graph, 3, 0);
+   auto [cost, discon_cnt] = graph.CalcScheduleCost(D, schedule);
 
-   cout << "Best cost: " << best_cost << endl;
-   cout << "Best Schedule: " << best_edge_schedule << endl;
+   cout << "Best cost: " << cost << endl;
+   cout << "Best Schedule: " << schedule << endl;
+   cerr << "Sum of daily cost=" << solver.GetBestCost() << " DisconCnt=" << discon_cnt << " Nodes=" << solver.GetNodeCount() << endl;
 
    return 0;
 }
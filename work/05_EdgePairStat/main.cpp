@@ -37,7 +37,8 @@ int main() {
       graph.AddEdge(u, v, w);
    }
 
-   graph.Prep();
+   // 辺を1本削除した時のコストも求める
+   graph.Prep(false, true);
 
    rep(i, N) {
       int x, y;
@@ -49,10 +50,7 @@ int main() {
    vector<ll> single_edge_cost(M);
 
    rep(e, M) {
-      vector<int> del_edge_list;
-      del_edge_list.emplace_back(e);
-
-      single_edge_cost[e] = graph.CalcCost(del_edge_list).first;
+      single_edge_cost[e] = graph.GetEdgeCost(e).first;
    }
 
    ll m = -1;
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "../Graph.hpp"
+#include "../debug.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+// clang-format on
+
+using ll = long long;
+
+// 辺ペアを同時に削除した時のコストの相互作用(ペアのコスト - 各辺単独のコストの和)を求める
+// - 全ペア(M^2 / 2)は評価せず、相互作用が0でない可能性があるペア(Graph::GetEdgePairBit)のみ評価する
+//   評価しないペアの相互作用は必ず0になるため、出力は全ペアを評価した場合と一致する
+// - 相互作用は距離の総和の差で求め、出力時に不満度の単位(1000 * x / (N(N - 1)))に換算する
+//   換算後に0になるペアは出力しない
+// - 相互作用が0でないペアをバイナリのCOO形式で出力する
+//
+// 使い方: ./main [出力ファイル(default: edge_pair.bin)] [スレッド数(default: 論理コア数)] < input
+//
+// 出力形式(リトルエンディアン):
+//   int32 N, int32 M, int64 nnz
+//   int64 single_cost[M]                  : 辺を1本削除した時のコスト
+//   (int32 e1, int32 e2, int64 diff)[nnz] : e1 < e2, (e1, e2)の昇順
+int main(int argc, char* argv[]) {
+   string output_path = argc > 1 ? argv[1] : "edge_pair.bin";
+   int thread_num = argc > 2 ? stoi(argv[2]) : (int)thread::hardware_concurrency();
+   thread_num = max(1, thread_num);
+
+   int N, M, D, K;
+   cin >> N >> M >> D >> K;
+
+   Graph graph(N);
+
+   rep(e, M) {
+      int u, v, w;
+      cin >> u >> v >> w;
+
+      graph.AddEdge(u, v, w);
+   }
+
+   rep(i, N) {
+      int x, y;
+      cin >> x >> y;
+
+      graph.SetNodeCoord(i + 1, x, y);
+   }
+
+   graph.Prep(false, true, true);
+
+   vector<ll> single_edge_cost(M);
+
+   rep(e, M) {
+      single_edge_cost[e] = graph.GetEdgeCost(e).first;
+   }
+
+   // 距離の総和の増加量を不満度に換算する
+   auto scale_cost = [&](ll dist) {
+      return 1000LL * dist / (N * (N - 1));
+   };
+
+   // e1ごとにスレッドへ割り当て、結果はe1ごとに保持して最後に連結する
+   using PairDiff = pair<int, ll>;  // e2, diff
+   vector<vector<PairDiff>> pair_diff_list(M);
+
+   atomic<int> next_e(0);
+   atomic<ll> eval_count(0);
+
+   auto worker = [&]() {
+      for (int e1 = next_e++; e1 < M; e1 = next_e++) {
+         const auto& cand = graph.GetEdgePairBit(e1);
+         ll cnt = 0;
+
+         for (int e2 = cand._Find_next(e1); e2 < M; e2 = cand._Find_next(e2)) {
+            ll dist = graph.CalcCostDist({e1, e2}).first;
+            ll diff = scale_cost(dist - graph.edge_cost_dist_[e1] - graph.edge_cost_dist_[e2]);
+            cnt++;
+
+            if (diff != 0) pair_diff_list[e1].emplace_back(e2, diff);
+         }
+
+         eval_count += cnt;
+      }
+   };
+
+   vector<thread> thread_list;
+
+   rep(i, thread_num - 1) {
+      thread_list.emplace_back(worker);
+   }
+
+   worker();
+
+   for (auto& th : thread_list) {
+      th.join();
+   }
+
+   ll nnz = 0;
+
+   rep(e1, M) {
+      nnz += pair_diff_list[e1].size();
+   }
+
+   cerr << "pairs: " << (ll)M * (M - 1) / 2 << " evaluated: " << eval_count << " nonzero: " << nnz << endl;
+
+   ofstream ofs(output_path, ios::binary);
+
+   if (!ofs) {
+      cerr << "cannot open " << output_path << endl;
+      return 1;
+   }
+
+   auto write = [&](auto value) {
+      ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+   };
+
+   write((int32_t)N);
+   write((int32_t)M);
+   write((int64_t)nnz);
+
+   rep(e, M) {
+      write((int64_t)single_edge_cost[e]);
+   }
+
+   rep(e1, M) {
+      for (auto [e2, diff] : pair_diff_list[e1]) {
+         write((int32_t)e1);
+         write((int32_t)e2);
+         write((int64_t)diff);
+      }
+   }
+
+   return 0;
+}
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <algorithm>
 
 #include "XorShift.hpp"
 #include "BypassSet.hpp"
@@ -13,142 +14,192 @@ template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} retu
 using namespace std;
 
 BypassSet::BypassSet(int D, int K, const Graph &graph)
-    : graph_(graph), D_(D), K_(K) {
-   int E = graph.GetEdgeList().size();
-
+    : graph_(graph), D_(D), K_(K), E_(graph.GetEdgeList().size()), in_bypass_edge_count_(0), over_k_count_(0) {
+   edge_day_.resize(E_, -1);
    day_edge_bit_.resize(D);
    day_bypass_bit_.resize(D);
-   in_bypass_edge_list_.resize(E);
-   bypass_generator_list_.resize(E);
+   day_bypass_count_.resize(D * E_, 0);
+   in_bypass_count_.resize(E_, 0);
+   day_edge_count_.resize(D, 0);
+
+   in_bypass_edge_set_ = IndexedSet(E_);
+   bypass_generator_set_ = IndexedSet(E_);
+}
+
+void BypassSet::SetAvailOneEdge(const EdgeBit &avail_one_edge) {
+   avail_one_edge_ = avail_one_edge;
+
+   rep(e, E_) {
+      UpdateSelectable(e);
+   }
+}
+
+void BypassSet::UpdateSelectable(int e) {
+   if (!avail_one_edge_[e] && BypassGeneratorCount(e) > 0) {
+      in_bypass_edge_set_.Insert(e);
+   } else {
+      in_bypass_edge_set_.Erase(e);
+   }
+
+   if (!avail_one_edge_[e] && in_bypass_count_[e] > 0) {
+      bypass_generator_set_.Insert(e);
+   } else {
+      bypass_generator_set_.Erase(e);
+   }
+}
+
+void BypassSet::UpdateDayEdgeCount(int d, int delta) {
+   over_k_count_ -= max(0, day_edge_count_[d] - K_);
+   day_edge_count_[d] += delta;
+   over_k_count_ += max(0, day_edge_count_[d] - K_);
 }
 
 void BypassSet::AddEdge(int d, int e) {
-   int E = graph_.GetEdgeList().size();
+   int *bypass_count = &day_bypass_count_[d * E_];
 
+   edge_day_[e] = d;
    day_edge_bit_[d][e] = 1;
+   UpdateDayEdgeCount(d, 1);
+
+   if (bypass_count[e] > 0) in_bypass_edge_count_++;
 
    if (day_bypass_bit_[d][e]) {
       // eが迂回路集合に含まれる
-      rep(p, E) {
-         if (!day_edge_bit_[d][p]) continue;
-         auto bypass_bit = graph_.GetBypassBit(p);
-
-         if (bypass_bit[e]) {
-            // pの迂回路集合にeが含まれる
-            in_bypass_edge_list_[p].insert(e);
-            bypass_generator_list_[e].insert(p);
-         }
+      // 迂回路にeを含む工事予定の辺pを列挙する
+      EdgeBit generator_bit = day_edge_bit_[d] & graph_.GetBypassRevBit(e);
+
+      for (int p = generator_bit._Find_first(); p < E_; p = generator_bit._Find_next(p)) {
+         if (in_bypass_count_[p]++ == 0) UpdateSelectable(p);
       }
    }
 
-   auto bypass_bit = graph_.GetBypassBit(e);
-   day_bypass_bit_[d] |= bypass_bit;
+   const auto &bypass_bit = graph_.GetBypassBit(e);
 
-   if ((day_edge_bit_[d] & bypass_bit).any()) {
-      // eの迂回路集合に工事予定の辺pが含まれる
-      rep(p, E) {
-         if (!day_edge_bit_[d][p]) continue;
-         if (!bypass_bit[p]) continue;
+   for (int p = bypass_bit._Find_first(); p < E_; p = bypass_bit._Find_next(p)) {
+      if (bypass_count[p]++ == 0) {
+         day_bypass_bit_[d][p] = 1;
 
-         in_bypass_edge_list_[e].insert(p);
-         bypass_generator_list_[p].insert(e);
+         if (day_edge_bit_[d][p]) {
+            in_bypass_edge_count_++;
+            UpdateSelectable(p);
+         }
       }
    }
+
+   // eの迂回路集合に含まれる工事予定の辺の数
+   in_bypass_count_[e] = (day_edge_bit_[d] & bypass_bit).count();
+   UpdateSelectable(e);
 }
 
 void BypassSet::DelEdge(int d, int e) {
-   int E = graph_.GetEdgeList().size();
+   int *bypass_count = &day_bypass_count_[d * E_];
 
+   assert(day_edge_bit_[d][e]);
+   edge_day_[e] = -1;
    day_edge_bit_[d][e] = 0;
+   UpdateDayEdgeCount(d, -1);
 
-   // 迂回路集合を再構築
-   day_bypass_bit_[d].reset();
+   if (bypass_count[e] > 0) in_bypass_edge_count_--;
 
-   rep(p, E) {
-      if (!day_edge_bit_[d][p]) continue;
-      day_bypass_bit_[d] |= graph_.GetBypassBit(p);
-   }
+   // 迂回路集合を更新
+   const auto &bypass_bit = graph_.GetBypassBit(e);
+
+   for (int p = bypass_bit._Find_first(); p < E_; p = bypass_bit._Find_next(p)) {
+      if (--bypass_count[p] == 0) {
+         day_bypass_bit_[d][p] = 0;
 
-   // eを生成元とするbypass_generator_list_の更新
-   for (auto q : in_bypass_edge_list_[e]) {
-      auto it = bypass_generator_list_[q].find(e);
-      assert(it != bypass_generator_list_[q].end());
-      bypass_generator_list_[q].erase(it);
+         if (day_edge_bit_[d][p]) {
+            in_bypass_edge_count_--;
+            UpdateSelectable(p);
+         }
+      }
    }
 
-   in_bypass_edge_list_[e].clear();
+   // eを迂回路に含む工事予定の辺の更新
+   if (bypass_count[e] > 0) {
+      EdgeBit generator_bit = day_edge_bit_[d] & graph_.GetBypassRevBit(e);
 
-   for (auto p : bypass_generator_list_[e]) {
-      auto it = in_bypass_edge_list_[p].find(e);
-      assert(it != in_bypass_edge_list_[p].end());
-      in_bypass_edge_list_[p].erase(it);
+      for (int p = generator_bit._Find_first(); p < E_; p = generator_bit._Find_next(p)) {
+         if (--in_bypass_count_[p] == 0) UpdateSelectable(p);
+      }
    }
 
-   bypass_generator_list_[e].clear();
+   in_bypass_count_[e] = 0;
+   UpdateSelectable(e);
 }
 
-int BypassSet::InBypassEdgeCount() const {
-   int count = 0;
-   int E = graph_.GetEdgeList().size();
+pair<int, int> BypassSet::CalcMoveDelta(int e, int to_d) const {
+   int from_d = edge_day_[e];
+   assert(from_d != -1 && from_d != to_d);
 
-   rep(e, E) {
-      if (!bypass_generator_list_[e].empty()) count++;
-   }
+   const int *from_count = &day_bypass_count_[from_d * E_];
+   const int *to_count = &day_bypass_count_[to_d * E_];
+   const auto &bypass_bit = graph_.GetBypassBit(e);
 
-   return count;
-}
+   int in_bypass_delta = 0;
 
-int BypassSet::SelectInBypassEdge(const EdgeBit &avail_one_edge) const {
-   int E = graph_.GetEdgeList().size();
-   vector<int> edge_list;
+   // from_dから削除: eと、eの迂回路にのみ含まれていた辺が迂回路集合から外れる
+   if (from_count[e] > 0) in_bypass_delta--;
 
-   rep(e, E) {
-      if (avail_one_edge[e]) continue;
-      if (!bypass_generator_list_[e].empty()) edge_list.emplace_back(e);
-   }
+   EdgeBit from_bit = day_edge_bit_[from_d] & bypass_bit;
 
-   if (edge_list.empty()) {
-      return -1;
+   for (int p = from_bit._Find_first(); p < E_; p = from_bit._Find_next(p)) {
+      if (from_count[p] == 1) in_bypass_delta--;
    }
 
-   assert(!edge_list.empty());
+   // to_dに追加: eと、eの迂回路に新たに含まれる辺が迂回路集合に入る
+   if (to_count[e] > 0) in_bypass_delta++;
 
-   int ind = XorShift() % edge_list.size();
-   return edge_list[ind];
-}
+   EdgeBit to_bit = day_edge_bit_[to_d] & bypass_bit;
 
-int BypassSet::SelectBypassGeneratorEdge(const EdgeBit &avail_one_edge) const {
-   int E = graph_.GetEdgeList().size();
-   vector<int> edge_list;
-
-   rep(e, E) {
-      if (avail_one_edge[e]) continue;
-      if (!in_bypass_edge_list_[e].empty()) edge_list.emplace_back(e);
+   for (int p = to_bit._Find_first(); p < E_; p = to_bit._Find_next(p)) {
+      if (to_count[p] == 0) in_bypass_delta++;
    }
 
-   if (edge_list.empty()) {
+   int over_k_delta = 0;
+
+   if (day_edge_count_[from_d] > K_) over_k_delta--;
+   if (day_edge_count_[to_d] >= K_) over_k_delta++;
+
+   return {in_bypass_delta, over_k_delta};
+}
+
+int BypassSet::SelectInBypassEdge() const {
+   if (in_bypass_edge_set_.Empty()) {
       return -1;
    }
 
-   assert(!edge_list.empty());
-
-   int ind = XorShift() % edge_list.size();
-   return edge_list[ind];
+   int ind = XorShift() % in_bypass_edge_set_.Size();
+   return in_bypass_edge_set_[ind];
 }
 
-int BypassSet::GetDay(int e) const {
-   rep(d, D_) if (day_edge_bit_[d][e]) return d;
-   return -1;
+int BypassSet::SelectBypassGeneratorEdge() const {
+   if (bypass_generator_set_.Empty()) {
+      return -1;
+   }
+
+   int ind = XorShift() % bypass_generator_set_.Size();
+   return bypass_generator_set_[ind];
 }
 
 BypassSet &BypassSet::operator=(const BypassSet &bypass_set) {
    D_ = bypass_set.D_;
    K_ = bypass_set.K_;
+   E_ = bypass_set.E_;
 
+   edge_day_ = bypass_set.edge_day_;
    day_edge_bit_ = bypass_set.day_edge_bit_;
    day_bypass_bit_ = bypass_set.day_bypass_bit_;
-   in_bypass_edge_list_ = bypass_set.in_bypass_edge_list_;
-   bypass_generator_list_ = bypass_set.bypass_generator_list_;
+   day_bypass_count_ = bypass_set.day_bypass_count_;
+   in_bypass_count_ = bypass_set.in_bypass_count_;
+   day_edge_count_ = bypass_set.day_edge_count_;
+
+   in_bypass_edge_count_ = bypass_set.in_bypass_edge_count_;
+   over_k_count_ = bypass_set.over_k_count_;
+
+   avail_one_edge_ = bypass_set.avail_one_edge_;
+   in_bypass_edge_set_ = bypass_set.in_bypass_edge_set_;
+   bypass_generator_set_ = bypass_set.bypass_generator_set_;
 
    return *this;
 }
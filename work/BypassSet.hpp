@@ -1,8 +1,8 @@
 #pragma once
 
 #include <vector>
-#include <set>
 #include "Graph.hpp"
+#include "IndexedSet.hpp"
 
 class BypassSetScheduler;
 
@@ -18,22 +18,42 @@ class BypassSet {
    void DelEdge(int d, int e);
 
    // 迂回路集合中の辺の数を返す
-   int InBypassEdgeCount() const;
+   // 計算量: O(1)
+   int InBypassEdgeCount() const {
+      return in_bypass_edge_count_;
+   }
+
+   // 工事辺数の上限Kを超過した辺数(日別の超過数の総和)を返す
+   // 計算量: O(1)
+   int OverKCount() const {
+      return over_k_count_;
+   }
+
+   // 辺eをto_d日目に移した場合の(迂回路集合中の辺の数, 工事辺数の上限Kを超過した辺数)の変化量を返す
+   // 計算量: O(迂回路の長さ)
+   std::pair<int, int> CalcMoveDelta(int e, int to_d) const;
+
+   // 選択対象から除く辺(工事可能日が1日のみの辺)を設定する
+   void SetAvailOneEdge(const EdgeBit& avail_one_edge);
 
    // 迂回路集合中の(day, edge)をランダムに返す
-   // 迂回路集合中に辺がない場合はassert and -1を返す
-   int SelectInBypassEdge(const EdgeBit& avail_one_edge) const;
+   // 迂回路集合中に辺がない場合は-1を返す
+   // 計算量: O(1)
+   int SelectInBypassEdge() const;
 
    // 迂回路集合に辺を持つ(day, edge)をランダムに返す
-   // 迂回路集合に辺を持つ辺がない場合はassert and -1を返す
-   int SelectBypassGeneratorEdge(const EdgeBit& avail_one_edge) const;
+   // 迂回路集合に辺を持つ辺がない場合は-1を返す
+   // 計算量: O(1)
+   int SelectBypassGeneratorEdge() const;
 
    // 工事日に含まれる辺の数を返す
    int GetDayEdgeCount(int d) const {
-      return day_edge_bit_[d].count();
+      return day_edge_count_[d];
    }
 
-   int GetDay(int e) const;
+   int GetDay(int e) const {
+      return edge_day_[e];
+   }
 
    const std::vector<EdgeBit>& GetDayEdgeBit() const {
       return day_edge_bit_;
@@ -46,10 +66,41 @@ class BypassSet {
    int D_;  // スケジュール日数
    int K_;  // 工事可能な辺数
 
-   std::vector<EdgeBit> day_edge_bit_;                 // day_edge_bit_[d]: 工事日dの辺集合
-   std::vector<EdgeBit> day_bypass_bit_;               // day_bypass_bit_[d]: 工事日dの迂回路集合
-   std::vector<std::set<int>> in_bypass_edge_list_;    // in_bypass_edge_list_[e]: eの迂回路中の工事予定辺のリスト
-   std::vector<std::set<int>> bypass_generator_list_;  // bypass_generator_list_[e]: eを含む迂回路の生成元リスト
+   // eの迂回路中の工事予定辺の数
+   int InBypassCount(int e) const {
+      return in_bypass_count_[e];
+   }
+
+   // eを含む迂回路の生成元の数
+   int BypassGeneratorCount(int e) const {
+      int d = edge_day_[e];
+      return d == -1 ? 0 : day_bypass_count_[d * E_ + e];
+   }
+
+   // eの選択候補への登録状態を更新する
+   void UpdateSelectable(int e);
+
+   // 工事日dの辺数を更新する
+   void UpdateDayEdgeCount(int d, int delta);
+
+   int E_;  // 辺数
+
+   // 迂回路の関係はすべて固定長の配列で持ち、代入を単純なコピーにする
+   // - eの迂回路中の工事予定辺: day_edge_bit_[d] & GetBypassBit(e)
+   // - eを含む迂回路の生成元: day_edge_bit_[d] & GetBypassRevBit(e)
+   std::vector<int> edge_day_;            // edge_day_[e]: 辺eの工事日(-1: 未定)
+   std::vector<EdgeBit> day_edge_bit_;    // day_edge_bit_[d]: 工事日dの辺集合
+   std::vector<EdgeBit> day_bypass_bit_;  // day_bypass_bit_[d]: 工事日dの迂回路集合
+   std::vector<int> day_bypass_count_;    // day_bypass_count_[d * E_ + p]: 工事日dの辺のうち迂回路にpを含む辺の数
+   std::vector<int> in_bypass_count_;     // in_bypass_count_[e]: eの迂回路中の工事予定辺の数
+   std::vector<int> day_edge_count_;      // day_edge_count_[d]: 工事日dの辺数
+
+   int in_bypass_edge_count_;  // 迂回路集合中の工事予定辺の数
+   int over_k_count_;          // 工事辺数の上限Kを超過した辺数
+
+   EdgeBit avail_one_edge_;           // 選択対象から除く辺
+   IndexedSet in_bypass_edge_set_;    // 迂回路集合中の工事予定辺(avail_one_edge_を除く)
+   IndexedSet bypass_generator_set_;  // 迂回路集合に辺を持つ工事予定辺(avail_one_edge_を除く)
 
    friend BypassSetScheduler;
 };
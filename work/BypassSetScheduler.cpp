@@ -31,6 +31,8 @@ void BypassSetScheduler::Initialize() {
       if (avail_cnt[e] == 1) avail_one_edge_[e] = 1;
    }
 
+   bypass_set_.SetAvailOneEdge(avail_one_edge_);
+
    // 初期集合を作る
    rep(e, E) {
       vector<int> day_list;
@@ -81,13 +83,8 @@ vector<int> BypassSetScheduler::MakeSchedule() {
          break;
       }
 
-      bypass_set_.DelEdge(from_d, trans_e);
-      bypass_set_.AddEdge(to_d, trans_e);
-
       // debug(trans_e, from_d, to_d);
-      auto trans_cost = CalcCost();
-
-      auto delta_improve = cur_cost - trans_cost;
+      auto delta_improve = -CalcMoveDelta(trans_e, to_d);
 
       bool search_update = false;
 
@@ -105,13 +102,14 @@ vector<int> BypassSetScheduler::MakeSchedule() {
       }
 
       if (!search_update) {
-         // 元に戻す
-         bypass_set_.DelEdge(to_d, trans_e);
-         bypass_set_.AddEdge(from_d, trans_e);
          continue;
       }
 
+      bypass_set_.DelEdge(from_d, trans_e);
+      bypass_set_.AddEdge(to_d, trans_e);
+
       cur_cost -= delta_improve;
+      assert(cur_cost == CalcCost());
 
       if (chmin(best_cost, cur_cost)) {
          best_bypass_set = bypass_set_;
@@ -139,14 +137,17 @@ int BypassSetScheduler::CalcCost() const {
    int cost = 0;
 
    cost += kBySetSA_EdgeInBypass * bypass_set_.InBypassEdgeCount();
-
-   rep(d, D_) {
-      if (bypass_set_.GetDayEdgeCount(d) > K_) cost += (bypass_set_.GetDayEdgeCount(d) - K_) * kBySetSA_OverK;
-   }
+   cost += kBySetSA_OverK * bypass_set_.OverKCount();
 
    return cost;
 }
 
+int BypassSetScheduler::CalcMoveDelta(int e, int to_d) const {
+   auto [in_bypass_delta, over_k_delta] = bypass_set_.CalcMoveDelta(e, to_d);
+
+   return kBySetSA_EdgeInBypass * in_bypass_delta + kBySetSA_OverK * over_k_delta;
+}
+
 BySetSA_Trans BypassSetScheduler::GenerateTransition() {
    // 工事辺数が超過している場合は解消する遷移を生成する
    rep(d, D_) {
@@ -175,9 +176,9 @@ BySetSA_Trans BypassSetScheduler::GenerateTransition() {
    int rnd = XorShift() % 100;
    int e = -1;
    if (rnd < kBySetSA_DefaultSelectInBypass) {
-      e = bypass_set_.SelectInBypassEdge(avail_one_edge_);
+      e = bypass_set_.SelectInBypassEdge();
    } else {
-      e = bypass_set_.SelectBypassGeneratorEdge(avail_one_edge_);
+      e = bypass_set_.SelectBypassGeneratorEdge();
    }
 
    if (e == -1) {
@@ -226,11 +227,15 @@ void BypassSetScheduler::InBypassTest() {
       rep(e, E) {
          if (!day_edge_bit[d][e]) continue;
          if (bypass_bit[e]) {
-            assert(!bypass_set_.bypass_generator_list_[e].empty());
+            assert(bypass_set_.BypassGeneratorCount(e) > 0);
             in_bypass_cnt++;
          } else {
-            assert(bypass_set_.bypass_generator_list_[e].empty());
+            assert(bypass_set_.BypassGeneratorCount(e) == 0);
          }
+
+         assert(bypass_set_.InBypassCount(e) == (int)(day_edge_bit[d] & graph_.GetBypassBit(e)).count());
+         assert(bypass_set_.in_bypass_edge_set_.Contains(e) == (!avail_one_edge_[e] && bypass_bit[e]));
+         assert(bypass_set_.bypass_generator_set_.Contains(e) == (!avail_one_edge_[e] && bypass_set_.InBypassCount(e) > 0));
       }
    }
 
@@ -46,6 +46,9 @@ class BypassSetScheduler {
    // BypassSetのコストを算出する
    int CalcCost() const;
 
+   // 辺eをto_d日目に移した場合のコストの変化量を算出する
+   int CalcMoveDelta(int e, int to_d) const;
+
    // 遷移先を生成する
    BySetSA_Trans GenerateTransition();
 
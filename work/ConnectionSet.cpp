@@ -15,45 +15,130 @@ template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} retu
 using ll = long long;
 
 ConnectionSet::ConnectionSet(int N, int D)
-    : Graph(N), D_(D), mt_(1234), max_temp_(kDefaultMaxTemp), min_temp_(kDefaultMinTemp) {
+    : Graph(N), D_(D), avail_one_bypass_set_(D, kDummyK, *this), mt_(1234), max_temp_(kDefaultMaxTemp), min_temp_(kDefaultMinTemp) {
    day_connection_set_.resize(D);
 }
 
-int ConnectionSet::CalcCost(const vector<EdgeBit> &day_connection_set) const {
+int ConnectionSet::AvailCountCost(int avail_count) {
+   if (avail_count == 0) return kCostNonAvailable;
+   if (avail_count == 1) return kCostOneAvailable;
+   if (avail_count == 2) return kCostTwoAvailable;
+
+   return 0;
+}
+
+void ConnectionSet::InitAvailCount() {
+   int E = (int)edge_list_.size();
+
+   edge_day_connection_.assign(E, 0);
+   non_avail_edge_bit_.reset();
+   avail_one_bypass_set_ = BypassSet(D_, kDummyK, *this);
+
+   rep(d, D_) {
+      const auto &connection_set = day_connection_set_[d];
+
+      for (int e = connection_set._Find_first(); e < E; e = connection_set._Find_next(e)) {
+         edge_day_connection_[e] |= 1U << d;
+      }
+   }
+
+   day_connectivity_.clear();
+
+   rep(d, D_) {
+      day_connectivity_.emplace_back(*this);
+      const auto &connection_set = day_connection_set_[d];
+
+      for (int e = connection_set._Find_first(); e < E; e = connection_set._Find_next(e)) {
+         day_connectivity_[d].AddEdge(e);
+      }
+   }
+
+   rep(e, E) {
+      int avail_count = AvailCount(e);
+
+      if (avail_count == 0) non_avail_edge_bit_[e] = 1;
+      if (avail_count == 1) avail_one_bypass_set_.AddEdge(AvailOneDay(e), e);
+   }
+}
+
+int ConnectionSet::SetConnection(int d, int e, bool connect) {
+   if (day_connection_set_[d][e] == connect) return 0;
+
+   int before_avail = AvailCount(e);
+   int after_avail = before_avail + (connect ? -1 : 1);
+   int before_in_bypass = avail_one_bypass_set_.InBypassEdgeCount();
+
+   // 工事可能な回数が1回の辺は工事可能日に迂回路集合へ登録しておく
+   if (before_avail == 1) avail_one_bypass_set_.DelEdge(AvailOneDay(e), e);
+
+   day_connection_set_[d][e] = connect;
+   edge_day_connection_[e] ^= 1U << d;
+
+   if (connect) {
+      day_connectivity_[d].AddEdge(e);
+   } else {
+      day_connectivity_[d].DelEdge(e);
+   }
+   non_avail_edge_bit_[e] = (after_avail == 0);
+
+   if (after_avail == 1) avail_one_bypass_set_.AddEdge(AvailOneDay(e), e);
+
+   int delta = AvailCountCost(after_avail) - AvailCountCost(before_avail);
+   delta += kCostConnect * (connect ? 1 : -1);
+   delta += kCostOneAvailableInBypass * (avail_one_bypass_set_.InBypassEdgeCount() - before_in_bypass);
+
+   return delta;
+}
+
+int ConnectionSet::ApplyTransition(const Trans &trans) {
+   const auto &[d, e, add_edge_bit] = trans;
+   int E = (int)edge_list_.size();
+   int delta = 0;
+
+   // 迂回路を先に追加して全域森の付け替えを減らす
+   for (int a = add_edge_bit._Find_first(); a < E; a = add_edge_bit._Find_next(a)) {
+      delta += SetConnection(d, a, true);
+   }
+
+   delta += SetConnection(d, e, false);
+
+   return delta;
+}
+
+int ConnectionSet::RevertTransition(const Trans &trans) {
+   const auto &[d, e, add_edge_bit] = trans;
+   int E = (int)edge_list_.size();
+   int delta = SetConnection(d, e, true);
+
+   for (int a = add_edge_bit._Find_first(); a < E; a = add_edge_bit._Find_next(a)) {
+      delta += SetConnection(d, a, false);
+   }
+
+   return delta;
+}
+
+int ConnectionSet::CalcCost() const {
    int cost = 0;
 
    // 辺ごとの工事可能な日数に対するコスト
    vector<vector<int>> day_avail_one_edge_list(D_);
 
    rep(e, edge_list_.size()) {
-      int avail_count = 0;
-      int avail_day = -1;
+      int avail_count = AvailCount(e);
+      cost += AvailCountCost(avail_count);
 
-      rep(d, D_) {
-         if (day_connection_set[d][e] == 0) {
-            avail_count++;
-            avail_day = d;
-         }
-      }
-
-      if (avail_count == 0) {
-         cost += kCostNonAvailable;
-      } else if (avail_count == 1) {
-         cost += kCostOneAvailable;
-         day_avail_one_edge_list[avail_day].emplace_back(e);
-      } else if (avail_count == 2) {
-         cost += kCostTwoAvailable;
+      if (avail_count == 1) {
+         day_avail_one_edge_list[AvailOneDay(e)].emplace_back(e);
       }
    }
 
    // 固定する連結成分の大きさに対するコスト
    rep(d, D_) {
-      cost += kCostConnect * day_connection_set[d].count();
+      cost += kCostConnect * day_connection_set_[d].count();
    }
 
    // 工事可能日が1日のもので迂回路集合に辺が入っていないかチェックする
-   int dummy_K = 3000;
-   BypassSet bypass_set(D_, dummy_K, *this);
+   BypassSet bypass_set(D_, kDummyK, *this);
 
    rep(d, D_) {
       for (auto e : day_avail_one_edge_list[d]) {
@@ -68,10 +153,10 @@ int ConnectionSet::CalcCost(const vector<EdgeBit> &day_connection_set) const {
 
 void ConnectionSet::InitDayConnectionSet() {
    int E = (int)edge_list_.size();
+   UnionFind uf(N_);
 
    rep(d, D_) {
-      // todo: UnionFindをresetして使いまわすと高速化？
-      UnionFind uf(N_);
+      uf.Reset();
       int cc_edge_cnt = 0;
 
       while (cc_edge_cnt < N_ - 1) {
@@ -89,29 +174,14 @@ void ConnectionSet::InitDayConnectionSet() {
 }
 
 Trans ConnectionSet::GenerateTransition() {
-   int E = (int)edge_list_.size();
-   EdgeBit non_avail_edge_bit;
-
-   rep(e, E) non_avail_edge_bit[e] = 1;
-
-   rep(d, D_) {
-      rep(e, E) {
-         if (day_connection_set_[d][e] == 0) non_avail_edge_bit[e] = 0;
-      }
-   }
-
    auto rnd = XorShift() % 100;
 
    auto edge_select = [&](int d, const EdgeBit &selectable_edge_bit) -> Trans {
-      vector<int> edge_list;
-
-      rep(e, E) {
-         if (!selectable_edge_bit[e]) continue;
-         edge_list.emplace_back(e);
-      }
+      // ind番目に立っているbitを選ぶ
+      int ind = XorShift() % selectable_edge_bit.count();
+      int e = selectable_edge_bit._Find_first();
 
-      int ind = XorShift() % edge_list.size();
-      int e = edge_list[ind];
+      rep(i, ind) e = selectable_edge_bit._Find_next(e);
 
       // 追加する辺集合
       auto add_edge_bit = edge_bypass_[e];
@@ -121,9 +191,9 @@ Trans ConnectionSet::GenerateTransition() {
       return {d, e, add_edge_bit};
    };
 
-   if (non_avail_edge_bit.any() && rnd < kDefaultSelectNotAvailable) {
+   if (non_avail_edge_bit_.any() && rnd < kDefaultSelectNotAvailable) {
       int d = XorShift() % D_;
-      auto trans = edge_select(d, non_avail_edge_bit);
+      auto trans = edge_select(d, non_avail_edge_bit_);
 
       return trans;
    } else {
@@ -141,8 +211,9 @@ vector<EdgeBit> ConnectionSet::CalcAvailEdgeSet() {
    // 初期化
    Prep(true);
    InitDayConnectionSet();
+   InitAvailCount();
 
-   int cur_cost = CalcCost(day_connection_set_);
+   int cur_cost = CalcCost();
 
    int best_cost = cur_cost;
    auto best_day_connection_set = day_connection_set_;
@@ -152,19 +223,20 @@ vector<EdgeBit> ConnectionSet::CalcAvailEdgeSet() {
       const double temp = max_temp_ + (min_temp_ - max_temp_) * progress;
 
       // 遷移
+      // 計算量: O(変化する辺数 * 迂回路集合の更新)
       auto trans = GenerateTransition();
+      int d = get<0>(trans);
+      int before_component = day_connectivity_[d].ComponentCount();
 
-      auto trans_day_connection_set = day_connection_set_;
+      auto delta_improve = -ApplyTransition(trans);
 
-      {
-         auto [d, e, add_edge_bit] = trans;
-         trans_day_connection_set[d][e] = 0;
-         trans_day_connection_set[d] |= add_edge_bit;
+      // 非連結になる遷移は行わない
+      // (迂回路はeの両端を結ぶため、迂回路がない橋を選んだ場合のみ該当する)
+      if (day_connectivity_[d].ComponentCount() > before_component) {
+         RevertTransition(trans);
+         continue;
       }
 
-      auto trans_cost = CalcCost(trans_day_connection_set);
-      auto delta_improve = cur_cost - trans_cost;
-
       bool search_update = false;
 
       if (delta_improve >= 0) {
@@ -181,13 +253,13 @@ vector<EdgeBit> ConnectionSet::CalcAvailEdgeSet() {
       }
 
       if (!search_update) {
+         RevertTransition(trans);
          continue;
       }
 
       // debug(i, cur_cost, delta_improve);
 
       // 遷移する
-      swap(trans_day_connection_set, day_connection_set_);
       cur_cost -= delta_improve;
 
       if (chmin(best_cost, cur_cost)) {
@@ -217,21 +289,9 @@ vector<EdgeBit> ConnectionSet::CalcAvailEdgeSet() {
 
 int ConnectionSet::DisconnectedDayCount() const {
    int discon_day = 0;
-   int E = (int)edge_list_.size();
 
    rep(d, D_) {
-      UnionFind uf(N_);
-
-      rep(e, E) {
-         if (day_connection_set_[d][e] == 1) {
-            auto [u, v, w] = edge_list_[e];
-            uf.Unite(u, v);
-         }
-      }
-
-      if ((int)uf.size(1) != N_) {
-         discon_day++;
-      }
+      if (day_connectivity_[d].ComponentCount() != 1) discon_day++;
    }
 
    return discon_day;
@@ -243,13 +303,7 @@ int ConnectionSet::AvailCountEdge(int count) const {
    int E = (int)edge_list_.size();
 
    rep(e, E) {
-      int avail_count = 0;
-
-      rep(d, D_) {
-         if (day_connection_set_[d][e] == 0) avail_count++;
-      }
-
-      if (avail_count == count) edge_count++;
+      if (AvailCount(e) == count) edge_count++;
    }
 
    return edge_count;
@@ -261,9 +315,7 @@ double ConnectionSet::ScheduleRoom() const {
    double min_schedule_room = D_;
 
    rep(d, D_) {
-      int avail_edge_cnt = 0;
-
-      rep(e, E) if (day_connection_set_[d][e] == 0) avail_edge_cnt++;
+      int avail_edge_cnt = E - (int)day_connection_set_[d].count();
 
       double schedule_room = 1.0 * avail_edge_cnt / average_edge;
       chmin(min_schedule_room, schedule_room);
@@ -273,26 +325,6 @@ double ConnectionSet::ScheduleRoom() const {
 }
 
 int ConnectionSet::AvailOneEdgeInBypassCount() const {
-   int dummy_K = 3000;
-   BypassSet bypass_set(D_, dummy_K, *this);
-
-   int E = (int)edge_list_.size();
-
-   rep(e, E) {
-      int avail_count = 0;
-      int avail_day = -1;
-
-      rep(d, D_) {
-         if (day_connection_set_[d][e] == 0) {
-            avail_day = d;
-            avail_count++;
-         }
-      }
-
-      if (avail_count == 1) {
-         bypass_set.AddEdge(avail_day, e);
-      }
-   }
-
-   return bypass_set.InBypassEdgeCount();
+   // 計算量: O(1)(迂回路集合はSetConnectionで更新済)
+   return avail_one_bypass_set_.InBypassEdgeCount();
 }
@@ -2,7 +2,10 @@
 
 #include <vector>
 #include <random>
+#include <cstdint>
 #include "Graph.hpp"
+#include "BypassSet.hpp"
+#include "DynamicConnectivity.hpp"
 
 // 遷移の種類
 enum TransType {
@@ -23,6 +26,8 @@ static constexpr int kCostOneAvailableInBypass = 1 * 2000;  // 工事可能な
 
 static constexpr int kCostConnect = 1;  // 連結集合のサイズのコスト(距離最小化の自由度を残すため連結集合のサイズは小さい方が良い)
 
+static constexpr int kDummyK = 3000;  // 迂回路集合の判定のみに使うため工事可能な辺数の上限は設けない
+
 // 焼きなまし法のパラメタ
 static constexpr int kDefaultMaxTemp = 2011;
 static constexpr int kDefaultMinTemp = 298;
@@ -39,12 +44,15 @@ class ConnectionSet
    std::vector<EdgeBit> CalcAvailEdgeSet();
 
    // 非連結な日数を返す
+   // @pre CalcAvailEdgeSet()を実行済であること
    int DisconnectedDayCount() const;
 
    // 工事可能な回数がcount回の辺数を返す
+   // @pre CalcAvailEdgeSet()を実行済であること
    int AvailCountEdge(int count) const;
 
    // 工事可能な回数が1回の辺のうち迂回路集合に入る辺の数を返す
+   // @pre CalcAvailEdgeSet()を実行済であること
    int AvailOneEdgeInBypassCount() const;
 
    // スケジュールの余裕度を返す
@@ -57,13 +65,42 @@ class ConnectionSet
    // 遷移先を生成する
    Trans GenerateTransition();
 
-   // 与えられた日別の連結な辺集合に対するコストを計算する
-   int CalcCost(const std::vector<EdgeBit>& day_connection_set) const;
+   // 現在の連結な辺集合に対するコストを計算する
+   int CalcCost() const;
+
+   // day_connection_set_から辺ごとの連結日マスク, 迂回路集合, 日別の連結性を初期化する
+   void InitAvailCount();
+
+   // d日目の連結な辺集合に辺eを追加/削除し、コストの変化量を返す
+   int SetConnection(int d, int e, bool connect);
+
+   // 遷移を適用/取り消し、コストの変化量を返す
+   int ApplyTransition(const Trans& trans);
+   int RevertTransition(const Trans& trans);
+
+   // 工事可能な回数に対するコスト
+   static int AvailCountCost(int avail_count);
+
+   // 辺eの工事可能な日数を返す
+   int AvailCount(int e) const {
+      return D_ - __builtin_popcount(edge_day_connection_[e]);
+   }
+
+   // 工事可能な回数が1回の辺の工事可能日を返す
+   int AvailOneDay(int e) const {
+      return __builtin_ctz(~edge_day_connection_[e]);
+   }
 
    int D_;  // スケジュール日数
 
    std::vector<EdgeBit> day_connection_set_;  // 日別の連結な辺集合
 
+   std::vector<uint32_t> edge_day_connection_;  // edge_day_connection_[e]: 辺eが連結な辺集合に含まれる日のbit(day_connection_set_の転置, D <= 30)
+   EdgeBit non_avail_edge_bit_;                 // 工事可能な日がない辺
+   BypassSet avail_one_bypass_set_;             // 工事可能な回数が1回の辺の迂回路集合
+
+   std::vector<DynamicConnectivity> day_connectivity_;  // day_connectivity_[d]: d日目の連結な辺集合の連結性
+
    std::mt19937_64 mt_;
 
    // 温度パラメタ
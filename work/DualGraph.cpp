@@ -1 +1,123 @@
-#include "DualGraph.hpp"
\ No newline at end of file
+#include <algorithm>
+#include <limits>
+#include "DualGraph.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+// clang-format on
+
+using ll = long long;
+
+DualGraph::DualGraph(const vector<pair<int, int>>& points)
+    : V_(points.size()), points_(points) {
+}
+
+void DualGraph::AddEdge(int u, int v) {
+   edge_node_.emplace_back(u, v);
+}
+
+int DualGraph::Build() {
+   int H = 2 * edge_node_.size();
+
+   // 始点ごとに半辺をまとめる
+   out_begin_.assign(V_ + 1, 0);
+
+   rep(h, H) out_begin_[Tail(h) + 1]++;
+   rep(u, V_) out_begin_[u + 1] += out_begin_[u];
+
+   out_half_.resize(H);
+   vector<int> fill_pos(out_begin_.begin(), out_begin_.end() - 1);
+
+   rep(h, H) out_half_[fill_pos[Tail(h)]++] = h;
+
+   // 偏角(-pi, pi]の昇順にソートする(整数演算のみで比較する)
+   // 0: (-pi, 0), 1: [0, pi), 2: pi
+   auto half_plane = [](ll x, ll y) {
+      if (y < 0) return 0;
+      return (y == 0 && x < 0) ? 2 : 1;
+   };
+
+   rep(u, V_) {
+      auto [ux, uy] = points_[u];
+
+      sort(out_half_.begin() + out_begin_[u], out_half_.begin() + out_begin_[u + 1], [&](int h1, int h2) {
+         ll x1 = points_[Head(h1)].first - ux, y1 = points_[Head(h1)].second - uy;
+         ll x2 = points_[Head(h2)].first - ux, y2 = points_[Head(h2)].second - uy;
+
+         int p1 = half_plane(x1, y1), p2 = half_plane(x2, y2);
+
+         if (p1 != p2) return p1 < p2;
+         return x1 * y2 - y1 * x2 > 0;
+      });
+   }
+
+   out_pos_.resize(H);
+
+   rep(u, V_) {
+      for (int i = out_begin_[u]; i < out_begin_[u + 1]; i++) {
+         out_pos_[out_half_[i]] = i - out_begin_[u];
+      }
+   }
+
+   // 外側の面: y座標が最大(同じならx座標が最小)のノードの最初の半辺からたどる
+   half_face_.assign(H, -1);
+   face_begin_.assign(1, 0);
+   face_half_.clear();
+   face_half_.reserve(H);
+
+   int max_y = numeric_limits<int>::min(), min_x = numeric_limits<int>::max(), id = -1;
+
+   rep(u, V_) {
+      auto [x, y] = points_[u];
+
+      if (max_y < y || (max_y == y && x < min_x)) {
+         max_y = y, min_x = x, id = u;
+      }
+   }
+
+   TraceFace(out_half_[out_begin_[id]], 0);
+
+   int face_cnt = 1;
+
+   rep(i, H) {
+      int h = out_half_[i];
+      if (half_face_[h] < 0) TraceFace(h, face_cnt++);
+   }
+
+   return face_cnt - 1;
+}
+
+void DualGraph::TraceFace(int g, int f) {
+   // 半辺hの次の半辺は、hの終点から出る半辺のうちh ^ 1の次(反時計回り)のもの
+   // 面には次の半辺から順にgまでの始点を並べる
+   int h = g;
+
+   do {
+      int cur = Head(h);
+      int deg = out_begin_[cur + 1] - out_begin_[cur];
+      int pos = out_pos_[h ^ 1] + 1;
+
+      if (pos == deg) pos = 0;
+
+      h = out_half_[out_begin_[cur] + pos];
+      half_face_[h] = f;
+      face_half_.emplace_back(h);
+   } while (h != g);
+
+   face_begin_.emplace_back(face_half_.size());
+}
+
+void DualGraph::GetFace(int f, vector<int>& node_list, vector<int>& edge_list) const {
+   node_list.clear();
+   edge_list.clear();
+
+   // 0番目の面は外側の面
+   for (int i = face_begin_[f + 1]; i < face_begin_[f + 2]; i++) {
+      int h = face_half_[i];
+
+      node_list.emplace_back(Tail(h) + 1);
+      edge_list.emplace_back(h >> 1);
+   }
+}
@@ -1,140 +1,61 @@
 #pragma once
 
-#include <iostream>
 #include <vector>
-#include <algorithm>
-#include <limits>
+#include <utility>
 
+// 平面グラフの面を列挙する
+// - 辺e = (u, v)に対して半辺2e: u -> v, 2e + 1: v -> uを持つ(逆向きの半辺はh ^ 1)
+// - 各ノードから出る半辺を偏角の昇順(反時計回り)に並べ、半辺をたどって面を求める
+// - 面の番号付けと面のノード順は参考実装と同じになる
 // 入力のグラフは連結であることを仮定
 // 平面グラフは 2 次元座標に埋め込んだ形で与える
 // 点が重なったり, 辺が交差したり, 辺が重なったりしないものとする.
 // 参考: https://kopricky.github.io/code/Graph/dual_graph.html
-
 class DualGraph {
-  private:
-   struct info {
-      int x, y, z;
-      info(const int _x, const int _y, const int _z)
-          : x(_x), y(_y), z(_z) {
-      }
-      bool operator<(const info& s) const {
-         if ((long long)y * s.y <= 0) {
-            if (y == 0 && s.y == 0) return (x >= 0 && s.x < 0);
-            if (y == 0 && s.y > 0) return (x >= 0);
-            if (y > 0 && s.y == 0) return (s.x < 0);
-            return (y < s.y);
-         } else if (((long long)x * s.x <= 0)) {
-            return (x == s.x) ? false : ((y > 0) ? (x > s.x) : (x < s.x));
-         } else {
-            return ((long long)y * s.x < (long long)x * s.y);
-         }
-      }
-   };
-
-   struct eda {
-      int to, rev, face;
-      eda(const int _to, const int _rev)
-          : to(_to), rev(_rev), face(-1) {
-      }
-   };
-   int V;
-   std::vector<std::vector<info>> pos;
-   std::vector<std::vector<eda>> G;
-   std::vector<std::pair<int, int>> pts;
+  public:
+   DualGraph(const std::vector<std::pair<int, int>>& points);
 
-   void sort_edges() {
-      for (int i = 0; i < V; ++i) sort(pos[i].begin(), pos[i].end());
-      for (int i = 0; i < V; ++i) {
-         for (int j = 0; j < (int)pos[i].size(); ++j) {
-            const info& e = pos[i][j];
-            const info arg(pts[i].first - pts[e.z].first, pts[i].second - pts[e.z].second, -1);
-            const int rev = (int)(lower_bound(pos[e.z].begin(), pos[e.z].end(), arg) - pos[e.z].begin());
-            G[i].emplace_back(e.z, rev);
-         }
-      }
-   }
+   // 辺(u, v)を追加する(ノードは0-indexed, 追加順がedge indexになる)
+   void AddEdge(int u, int v);
 
-   void search_outside_face() {
-      int mxy = std::numeric_limits<int>::min(), mnx = std::numeric_limits<int>::max(), id = -1;
-      for (int i = 0; i < V; ++i) {
-         if (mxy < pts[i].second) {
-            mxy = pts[i].second, mnx = pts[i].first, id = i;
-         } else if (mxy == pts[i].second && pts[i].first < mnx) {
-            mnx = pts[i].first, id = i;
-         }
-      }
-      search(G[id][0].to, G[id][0].rev, 0, {id, 0});
-   }
-   void search(int cur, int id, const int f, const std::pair<int, int>& goal) {
-      while (true) {
-         id = (id < (int)G[cur].size() - 1) ? (id + 1) : (0);
-         auto& e = G[cur][id];
-         faces[e.face = f].push_back(cur);
-         if (cur == goal.first && id == goal.second) break;
-         cur = e.to, id = e.rev;
-      }
-   }
-   void construct_dgraph(const int node_size) {
-      DG.resize(node_size);
-      for (int i = 0; i < V; ++i) {
-         for (const eda& e : G[i]) {
-            DG[e.face].emplace_back(G[e.to][e.rev].face, std::make_pair(i, e.to));
-         }
-      }
-   }
+   // 面を列挙し、外側の面を除いた面の数を返す
+   // 計算量: O(V + E log E)
+   int Build();
 
-  public:
-   // vector<vector<edge> > DG: 双対グラフ
-   // faces[u]: 双対グラフの頂点 u に対応する元のグラフの面(点集合は右回りにならぶ)
-   // faces[0] は外側の面に対応する(見た目上は左回りに並んでいるように見える).
-   struct edge {
-      int to;
-      // 元のグラフ上での対応する辺 e = (u, v) を格納
-      // 正確に u → v のベクトルの右側が from の面, 左側が to の面に対応する
-      std::pair<int, int> e;
-      edge(const int _to, const std::pair<int, int>& _e)
-          : to(_to), e(_e) {
-      }
-   };
+   // 面f(0-indexed, 外側の面を除く)のノード(1-indexed)と辺を返す
+   // edge_list[k]はnode_list[k]とnode_list[k + 1](末尾は先頭)を結ぶ辺
+   // ノードは右回りに並ぶ
+   void GetFace(int f, std::vector<int>& node_list, std::vector<int>& edge_list) const;
 
-   std::vector<std::vector<edge>> DG;
-   std::vector<std::vector<int>> faces;
+   // 半辺hが属する面を返す(-1: 外側の面)
+   // 辺eの両側の面はGetHalfEdgeFace(2e), GetHalfEdgeFace(2e + 1)
+   int GetHalfEdgeFace(int h) const {
+      return half_face_[h] - 1;
+   }
 
-   DualGraph(const std::vector<std::pair<int, int>>& points)
-       : V((int)points.size()), pos(V), G(V), pts(points) {
+  protected:
+   // 半辺hの始点/終点
+   int Tail(int h) const {
+      return (h & 1) ? edge_node_[h >> 1].second : edge_node_[h >> 1].first;
    }
-   void add_edge(const int u, const int v) {
-      pos[u].emplace_back(pts[v].first - pts[u].first, pts[v].second - pts[u].second, v);
-      pos[v].emplace_back(pts[u].first - pts[v].first, pts[u].second - pts[v].second, u);
+
+   int Head(int h) const {
+      return (h & 1) ? edge_node_[h >> 1].first : edge_node_[h >> 1].second;
    }
-   // 双対グラフの面リストを返す
-   std::vector<std::vector<int>> build() {
-      sort_edges();
-      faces.push_back(std::vector<int>());
-      search_outside_face();
-      int cnt = 1;
-      for (int i = 0; i < V; ++i) {
-         for (int j = 0; j < (int)G[i].size(); ++j) {
-            const eda& e = G[i][j];
-            if (e.face < 0) {
-               faces.push_back(std::vector<int>());
-               search(e.to, e.rev, cnt++, {i, j});
-            }
-         }
-      }
 
-      construct_dgraph(cnt);
+   // 半辺gから面をたどり、面番号fを割り当てる
+   void TraceFace(int g, int f);
 
-      std::vector<std::vector<int>> face_node_list(cnt - 1);
+   int V_;  // ノード数
 
-      for (int i = 1; i < cnt; i++) {
-         int L = faces[i].size();
-         face_node_list[i - 1].resize(L, 0);
+   std::vector<std::pair<int, int>> points_;     // ノードの座標
+   std::vector<std::pair<int, int>> edge_node_;  // edge_node_[e]: 辺eの端点
 
-         for (int j = 0; j < L; j++) {
-            face_node_list[i - 1][j] = faces[i][j] + 1;
-         }
-      }
-      return face_node_list;
-   }
-};
\ No newline at end of file
+   std::vector<int> out_begin_;  // ノードuから出る半辺はout_half_[out_begin_[u], out_begin_[u + 1])
+   std::vector<int> out_half_;   // ノードごとに偏角の昇順に並べた半辺
+   std::vector<int> out_pos_;    // out_pos_[h]: 始点から出る半辺のうちhの順番
+   std::vector<int> half_face_;  // half_face_[h]: 半辺hの面番号(0: 外側の面)
+
+   std::vector<int> face_begin_;  // 面fの半辺はface_half_[face_begin_[f], face_begin_[f + 1])
+   std::vector<int> face_half_;   // 面ごとの半辺
+};
@@ -0,0 +1,240 @@
+#include <utility>
+#include "DynamicConnectivity.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+// clang-format on
+
+DynamicConnectivity::DynamicConnectivity(const Graph& graph)
+    : graph_(graph), N_(graph.GetNodeSize()), component_count_(N_), stamp_(0) {
+   left_.resize(N_ + 1, 0);
+   right_.resize(N_ + 1, 0);
+   lct_parent_.resize(N_ + 1, 0);
+   reverse_.resize(N_ + 1, 0);
+   mark_.resize(N_ + 1, 0);
+}
+
+void DynamicConnectivity::Clear() {
+   edge_bit_.reset();
+   tree_edge_bit_.reset();
+   component_count_ = N_;
+
+   fill(left_.begin(), left_.end(), 0);
+   fill(right_.begin(), right_.end(), 0);
+   fill(lct_parent_.begin(), lct_parent_.end(), 0);
+   fill(reverse_.begin(), reverse_.end(), 0);
+}
+
+bool DynamicConnectivity::IsRoot(int x) const {
+   int p = lct_parent_[x];
+   return p == 0 || (left_[p] != x && right_[p] != x);
+}
+
+void DynamicConnectivity::Push(int x) {
+   if (!reverse_[x]) return;
+
+   swap(left_[x], right_[x]);
+
+   if (left_[x] != 0) reverse_[left_[x]] ^= 1;
+   if (right_[x] != 0) reverse_[right_[x]] ^= 1;
+
+   reverse_[x] = 0;
+}
+
+void DynamicConnectivity::Rotate(int x) {
+   int p = lct_parent_[x];
+   int g = lct_parent_[p];
+
+   if (!IsRoot(p)) {
+      if (left_[g] == p) {
+         left_[g] = x;
+      } else {
+         right_[g] = x;
+      }
+   }
+
+   lct_parent_[x] = g;
+
+   if (left_[p] == x) {
+      left_[p] = right_[x];
+      if (right_[x] != 0) lct_parent_[right_[x]] = p;
+      right_[x] = p;
+   } else {
+      right_[p] = left_[x];
+      if (left_[x] != 0) lct_parent_[left_[x]] = p;
+      left_[x] = p;
+   }
+
+   lct_parent_[p] = x;
+}
+
+void DynamicConnectivity::Splay(int x) {
+   // 根から順に遅延フラグを解消する
+   stack_.clear();
+
+   for (int y = x;; y = lct_parent_[y]) {
+      stack_.emplace_back(y);
+      if (IsRoot(y)) break;
+   }
+
+   for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+      Push(*it);
+   }
+
+   while (!IsRoot(x)) {
+      int p = lct_parent_[x];
+
+      if (!IsRoot(p)) {
+         int g = lct_parent_[p];
+         bool zigzig = (left_[g] == p) == (left_[p] == x);
+         Rotate(zigzig ? p : x);
+      }
+
+      Rotate(x);
+   }
+}
+
+void DynamicConnectivity::Access(int x) {
+   int last = 0;
+
+   for (int y = x; y != 0; y = lct_parent_[y]) {
+      Splay(y);
+      right_[y] = last;
+      last = y;
+   }
+
+   Splay(x);
+}
+
+void DynamicConnectivity::MakeRoot(int x) {
+   Access(x);
+   reverse_[x] ^= 1;
+   Push(x);
+}
+
+int DynamicConnectivity::FindRoot(int x) {
+   Access(x);
+
+   while (true) {
+      Push(x);
+      if (left_[x] == 0) break;
+      x = left_[x];
+   }
+
+   Splay(x);
+   return x;
+}
+
+void DynamicConnectivity::Link(int x, int y) {
+   MakeRoot(x);
+   lct_parent_[x] = y;
+}
+
+void DynamicConnectivity::Cut(int x, int y) {
+   MakeRoot(x);
+   Access(y);
+
+   // yのsplay木はx-yの2ノードのみ
+   left_[y] = 0;
+   lct_parent_[x] = 0;
+}
+
+bool DynamicConnectivity::IsConnected(int node_1, int node_2) {
+   if (node_1 == node_2) return true;
+
+   return FindRoot(node_1) == FindRoot(node_2);
+}
+
+void DynamicConnectivity::AddEdge(int e) {
+   if (edge_bit_[e]) return;
+
+   edge_bit_[e] = 1;
+
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+
+   if (IsConnected(u, v)) return;
+
+   Link(u, v);
+   tree_edge_bit_[e] = 1;
+   component_count_--;
+}
+
+void DynamicConnectivity::DelEdge(int e) {
+   if (!edge_bit_[e]) return;
+
+   edge_bit_[e] = 0;
+
+   if (!tree_edge_bit_[e]) return;
+
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+
+   Cut(u, v);
+   tree_edge_bit_[e] = 0;
+
+   int replace_edge = FindReplaceEdge(e);
+
+   if (replace_edge == -1) {
+      component_count_++;
+      return;
+   }
+
+   auto [x, y, w2] = graph_.GetEdgeList()[replace_edge];
+
+   Link(x, y);
+   tree_edge_bit_[replace_edge] = 1;
+}
+
+int DynamicConnectivity::FindReplaceEdge(int e) {
+   const auto& adj_list = graph_.adj_list_;
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+
+   // u側, v側の木を交互にBFSし、先に探索し終えた方を小さい側とする
+   // mark_: stamp_ + 0 -> u側, stamp_ + 1 -> v側
+   stamp_ += 2;
+
+   int start[2] = {u, v};
+   size_t head[2] = {0, 0};
+
+   rep(side, 2) {
+      queue_[side].clear();
+      queue_[side].emplace_back(start[side]);
+      mark_[start[side]] = stamp_ + side;
+   }
+
+   int small_side = -1;
+
+   while (small_side == -1) {
+      rep(side, 2) {
+         auto& queue = queue_[side];
+
+         if (head[side] == queue.size()) {
+            small_side = side;
+            break;
+         }
+
+         int node = queue[head[side]++];
+
+         for (const auto& [edge_index, node_to, weight] : adj_list[node]) {
+            if (!tree_edge_bit_[edge_index]) continue;
+            if (mark_[node_to] == stamp_ + side) continue;
+
+            mark_[node_to] = stamp_ + side;
+            queue.emplace_back(node_to);
+         }
+      }
+   }
+
+   // 小さい側から外に出る辺を探す
+   for (auto node : queue_[small_side]) {
+      for (const auto& [edge_index, node_to, weight] : adj_list[node]) {
+         if (!edge_bit_[edge_index]) continue;
+         if (mark_[node_to] == stamp_ + small_side) continue;
+
+         return edge_index;
+      }
+   }
+
+   return -1;
+}
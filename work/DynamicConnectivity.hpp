@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include "Graph.hpp"
+
+// 辺の追加/削除に対してグラフの連結性を管理するクラス
+// - 全域森をLink-Cut Treeで保持し、2点の連結判定をO(log N)(償却)で行う
+// - 全域森の辺を削除した場合は小さい側の木から代わりの辺を探索する
+//   計算量: O(小さい側のノード数 * 次数 + log N)
+class DynamicConnectivity {
+  public:
+   DynamicConnectivity(const Graph& graph);
+
+   // 辺がない状態に戻す
+   void Clear();
+
+   // 辺eを追加/削除する
+   void AddEdge(int e);
+   void DelEdge(int e);
+
+   // 辺eが含まれているか
+   bool Contains(int e) const {
+      return edge_bit_[e];
+   }
+
+   // node_1とnode_2が連結か
+   // 計算量: O(log N)(償却)
+   bool IsConnected(int node_1, int node_2);
+
+   // 連結成分の数を返す
+   int ComponentCount() const {
+      return component_count_;
+   }
+
+  protected:
+   // Link-Cut Treeの操作
+   bool IsRoot(int x) const;
+   void Push(int x);
+   void Rotate(int x);
+   void Splay(int x);
+   void Access(int x);
+   void MakeRoot(int x);
+   int FindRoot(int x);
+   void Link(int x, int y);
+   void Cut(int x, int y);
+
+   // 全域森から辺eを除いた後、eの両端を結ぶ代わりの辺を探す(-1: なし)
+   int FindReplaceEdge(int e);
+
+   const Graph& graph_;
+
+   int N_;  // ノード数
+
+   EdgeBit edge_bit_;       // 含まれている辺
+   EdgeBit tree_edge_bit_;  // 全域森の辺
+   int component_count_;    // 連結成分の数
+
+   // Link-Cut Tree(ノードIDは1-indexed, 0はnull)
+   std::vector<int> left_;        // 左の子
+   std::vector<int> right_;       // 右の子
+   std::vector<int> lct_parent_;  // 親(splay木の親またはpath-parent)
+   std::vector<char> reverse_;    // 反転の遅延フラグ
+
+   // 作業領域
+   std::vector<int> stack_;
+   std::vector<int> queue_[2];
+   std::vector<int> mark_;
+   int stamp_;
+};
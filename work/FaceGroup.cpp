@@ -2,6 +2,7 @@
 
 #include "DualGraph.hpp"
 #include "FaceGroup.hpp"
+#include "Profile.hpp"
 
 // clang-format off
 #define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
@@ -14,23 +15,24 @@ template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} retu
 
 using namespace std;
 
-Face::Face(const Graph& graph, const vector<Node>& node_list)
-    : graph_(graph), rect_{1001, 1001, -1, -1} {
+Face::Face(const Graph& graph, const vector<Node>& node_list, const vector<int>& edge_index_list)
+    : graph_(graph), rect_{1001, 1001, -1, -1}, unselected_count_(0), max_pos_(0) {
    int L = node_list.size();
    assert(L >= 3);
 
-   for (int i = 1; i <= L; i++) {
-      int u = node_list[i - 1];
-      int v = node_list[i % L];
-
-      int e = graph.GetEdgeIndex(u, v);
+   for (auto e : edge_index_list) {
       int b = graph.GetEdgeBetweenness(e);
 
       edge_list_.emplace_back(b, e);
-      unselected_.insert(e);
    }
 
    sort(edge_list_.rbegin(), edge_list_.rend());
+   selected_.assign(L, 0);
+
+   // 同じ辺はソート後に隣接する
+   rep(i, L) {
+      if (i == 0 || edge_list_[i] != edge_list_[i - 1]) unselected_count_++;
+   }
 
    int x_min = 1001, y_min = 1001, x_max = -1, y_max = -1;
 
@@ -46,31 +48,22 @@ Face::Face(const Graph& graph, const vector<Node>& node_list)
    rect_ = make_tuple(x_min, y_min, x_max, y_max);
 }
 
-int Face::MaxBetweenness() const {
-   for (auto [b, e] : edge_list_) {
-      if (selected_.count(e)) continue;
-      return b;
-   }
-
-   return 0;
-}
-
 void Face::Select(const int e) {
-   auto it = unselected_.find(e);
-   assert(it != unselected_.end());
-
-   unselected_.erase(it);
-   selected_.insert(e);
-}
+   bool found = false;
 
-bool Face::IsAdjacent(const Face& face) const {
-   const auto& edge_list = face.GetEdgeList();
+   rep(i, edge_list_.size()) {
+      if (edge_list_[i].second != e || selected_[i]) continue;
 
-   for (auto [b, e] : edge_list) {
-      if (unselected_.count(e) || selected_.count(e)) return true;
+      selected_[i] = 1;
+      found = true;
    }
 
-   return false;
+   assert(found);
+   unselected_count_--;
+
+   while (max_pos_ < (int)edge_list_.size() && selected_[max_pos_]) {
+      max_pos_++;
+   }
 }
 
 int Face::RectSize() const {
@@ -81,60 +74,50 @@ int Face::RectSize() const {
    return dx + dy;
 }
 
-vector<EdgeBetween> Face::GetUnselectedEdgeList() const {
-   vector<EdgeBetween> edge_list;
-
-   for (auto [b, e] : edge_list_) {
-      if (unselected_.count(e)) {
-         edge_list.emplace_back(b, e);
-      }
-   }
-
-   return edge_list;
-}
-
 FaceGroup::FaceGroup(int N, int D)
     : Graph(N), D_(D) {
 }
 
 vector<Faces> FaceGroup::MakeGroup() {
+   PROFILE_SCOPE("FaceGroup::MakeGroup");
+
    Prep(false);
    GenerateFaces();  // 面の生成
 
    int E = edge_list_.size();
    int F = face_list_.size();
 
-   // 辺 -> 面indexの対応
-   vector<vector<int>> edge_to_face_index(E);
-
-   rep(i, F) {
-      const auto& face = face_list_[i];
-      const auto face_edge_list = face.GetEdgeList();
-
-      for (auto [b, e] : face_edge_list) {
-         edge_to_face_index[e].emplace_back(i);
-      }
-   }
+   // 選択候補の面の登録
+   face_heap_ = IndexedHeap<FaceKey>(F);
 
-   // Max betweennessの算出
    rep(i, F) {
-      const auto& face = face_list_[i];
-      auto max_bet = face.MaxBetweenness();
-
-      face_max_bet_map_[max_bet].insert(i);
+      UpdateFaceHeap(i);
    }
 
    // 面の隣接リストの作成
+   // 辺を共有する面同士が隣接する
+   // 計算量: O(E + F log F)
    face_adj_list_.resize(F);
 
-   rep(i, F) rep(j, i) {
-      if (face_list_[i].IsAdjacent(face_list_[j])) {
-         face_adj_list_[i].emplace_back(j);
-         face_adj_list_[j].emplace_back(i);
+   rep(e, E) {
+      const auto& face_index_list = edge_to_face_index_[e];
+
+      for (auto i : face_index_list) {
+         for (auto j : face_index_list) {
+            if (i == j) continue;
+            face_adj_list_[i].emplace_back(j);
+         }
       }
    }
 
+   for (auto& adj_list : face_adj_list_) {
+      sort(adj_list.begin(), adj_list.end());
+      adj_list.erase(unique(adj_list.begin(), adj_list.end()), adj_list.end());
+   }
+
    // 面集合の生成
+   vector<int> select_edge_list;
+
    while (true) {
       auto face_group = Greedy();
 
@@ -142,36 +125,23 @@ vector<Faces> FaceGroup::MakeGroup() {
       face_group_list_.emplace_back(face_group);
 
       // 辺を選択
-      map<int, int> update_face_index;  // max betweennessの更新が必要なface index
-
       for (auto face_index : face_group) {
-         auto edge_list = face_list_[face_index].GetUnselectedEdgeList();
+         // 選択により未選択の辺が変わるため先に列挙しておく
+         select_edge_list.clear();
 
-         for (auto [b, e] : edge_list) {
-            for (auto i : edge_to_face_index[e]) {
-               if (!update_face_index.count(i)) {
-                  update_face_index[i] = face_list_[i].MaxBetweenness();
-               }
+         face_list_[face_index].ForEachUnselected([&](int b, int e) {
+            select_edge_list.emplace_back(e);
+         });
 
+         for (auto e : select_edge_list) {
+            for (auto i : edge_to_face_index_[e]) {
                face_list_[i].Select(e);
+
+               // Max betweennessと未選択の辺数が変わるため更新する
+               UpdateFaceHeap(i);
             }
          }
       }
-
-      // Max betweennessを更新
-      for (auto [face_index, prev_max] : update_face_index) {
-         // 更新前のmax betweennessを削除
-         auto prev_max_it = face_max_bet_map_.find(prev_max);
-         assert(prev_max_it != face_max_bet_map_.end());
-
-         auto prev_it = prev_max_it->second.find(face_index);
-         assert(prev_it != prev_max_it->second.end());
-         prev_max_it->second.erase(prev_it);
-
-         // 更新
-         int max_bet = face_list_[face_index].MaxBetweenness();
-         face_max_bet_map_[max_bet].insert(face_index);
-      }
    }
 
    vector<Faces> face_group_list(face_group_list_.size());
@@ -207,18 +177,28 @@ vector<Faces> FaceGroup::MakeGroup() {
    */
 }
 
-bool FaceGroup::CanFaceGroup(const std::vector<int>& face_index_list, int adj_face_index) const {
-   // 迂回路が大きくなり過ぎないように連結成分の「大きさ」でも制限をかける
-   auto [x_min, y_min, x_max, y_max] = face_list_[adj_face_index].GetRect();
+void FaceGroup::AddFace(GrowingFaceGroup& face_group, int face_index) const {
+   auto& [x_min, y_min, x_max, y_max] = face_group.rect;
+   auto [x1, y1, x2, y2] = face_list_[face_index].GetRect();
 
-   for (auto i : face_index_list) {
-      auto [x1, y1, x2, y2] = face_list_[i].GetRect();
+   chmin(x_min, x1);
+   chmin(y_min, y1);
+   chmax(x_max, x2);
+   chmax(y_max, y2);
 
-      chmin(x_min, x1);
-      chmin(y_min, y1);
-      chmax(x_max, x2);
-      chmax(y_max, y2);
-   }
+   face_group.face_index_list.emplace_back(face_index);
+   face_group.member_bit[face_index] = 1;
+}
+
+bool FaceGroup::CanFaceGroup(const GrowingFaceGroup& face_group, int adj_face_index) const {
+   // 迂回路が大きくなり過ぎないように連結成分の「大きさ」でも制限をかける
+   auto [x_min, y_min, x_max, y_max] = face_group.rect;
+   auto [x1, y1, x2, y2] = face_list_[adj_face_index].GetRect();
+
+   chmin(x_min, x1);
+   chmin(y_min, y1);
+   chmax(x_max, x2);
+   chmax(y_max, y2);
 
    // ToDo: tuning
    int dx = x_max - x_min, dy = y_max - y_min;
@@ -227,44 +207,33 @@ bool FaceGroup::CanFaceGroup(const std::vector<int>& face_index_list, int adj_fa
       // cerr << "size over" << endl;
       return false;
    }
+   // FaceGroupの中で決定する部分サイクルの短いもの((未選択の辺数, face_index)の昇順)から順に作っていく
+   // 各面の日数は自身より前の面で決まっていない辺の数になる
+   // - 追加する面より後ろの面の日数は減少のみで、追加前にD日以内であることを確認済
+   // - そのため追加する面の日数のみ確認すればよい
+   // 辺は高々2面に含まれ、未選択かどうかは両面で一致する
    using FaceSize = pair<int, int>;  // 辺の数, face_index
-   vector<FaceSize> face_size_list;
-   face_size_list.reserve(face_index_list.size() + 1);
-
-   face_size_list.emplace_back(
-       face_list_[adj_face_index].UnselectedCount(), adj_face_index);
-
-   for (auto i : face_index_list) {
-      int d = face_list_[i].UnselectedCount();
-      face_size_list.emplace_back(d, i);
-   }
-
-   // FaceGroupの中で決定する部分サイクルの短いものから順に作っていく
-   sort(face_size_list.begin(), face_size_list.end());
-   int max_d = -1;
-   EdgeBit selected;
+   const auto& adj_face = face_list_[adj_face_index];
+   const FaceSize adj_face_size(adj_face.UnselectedCount(), adj_face_index);
 
-   for (auto [d, i] : face_size_list) {
-      auto edge_list = face_list_[i].GetUnselectedEdgeList();
+   int face_d = 0;
+   int prev_e = -1;
 
-      int face_d = 0;
+   adj_face.ForEachUnselected([&](int b, int e) {
+      // 面の境界に2回現れる辺は隣接して列挙される
+      if (e == prev_e) return;
+      prev_e = e;
 
-      for (auto [b, e] : edge_list) {
-         if (selected[e]) continue;
-
-         selected[e] = true;
-         face_d++;
+      for (auto i : edge_to_face_index_[e]) {
+         if (i == adj_face_index || !face_group.member_bit[i]) continue;
+         if (FaceSize(face_list_[i].UnselectedCount(), i) < adj_face_size) return;
       }
 
-      // 部分サイクルの作成にD日より日数がかかる場合は結合しない
-      if (chmax(max_d, face_d)) {
-         if (max_d > D_) {
-            return false;
-         }
-      }
-   }
+      face_d++;
+   });
 
-   return true;
+   // 部分サイクルの作成にD日より日数がかかる場合は結合しない
+   return face_d <= D_;
 }
 
 void FaceGroup::GenerateFaces() {
@@ -278,58 +247,66 @@ void FaceGroup::GenerateFaces() {
    DualGraph dual_graph(coord_list);
 
    for (auto [u, v, w] : edge_list_) {
-      dual_graph.add_edge(u - 1, v - 1);
+      dual_graph.AddEdge(u - 1, v - 1);
    }
 
-   auto face_node_list = dual_graph.build();
-   face_list_.reserve(face_node_list.size());
+   int F = dual_graph.Build();
+   face_list_.reserve(F);
 
-   for (const auto& node_list : face_node_list) {
-      face_list_.emplace_back(*this, node_list);
+   vector<Node> node_list;
+   vector<int> edge_index_list;
+
+   rep(f, F) {
+      dual_graph.GetFace(f, node_list, edge_index_list);
+      face_list_.emplace_back(*this, node_list, edge_index_list);
    }
-}
 
-vector<int> FaceGroup::Greedy() {
-   int face_index = -1;
+   // 辺 -> 面indexの対応(外側の面は除く)
+   int E = edge_list_.size();
+   edge_to_face_index_.assign(E, vector<int>());
 
-   // Edge Betweennessの大きいものから考慮する
-   for (auto it = face_max_bet_map_.rbegin(); it != face_max_bet_map_.rend(); ++it) {
-      auto [max_b, face_set] = *it;
-      face_index = -1;
-      int min_rect_size = numeric_limits<int>::max();
+   rep(e, E) {
+      int f1 = dual_graph.GetHalfEdgeFace(2 * e);
+      int f2 = dual_graph.GetHalfEdgeFace(2 * e + 1);
 
-      for (auto i : face_set) {
-         // 未選択の辺がD本以下(スケジュール内で連結性を保つため)のものを選択
-         // 矩形サイズが小さいものから選択
-         if (face_bit_[i]) continue;
-         if (face_list_[i].UnselectedCount() > D_) continue;
+      if (f1 > f2) swap(f1, f2);
 
-         int rect_size = face_list_[i].RectSize();
+      if (f1 >= 0) edge_to_face_index_[e].emplace_back(f1);
+      if (f2 >= 0) edge_to_face_index_[e].emplace_back(f2);
+   }
+}
 
-         if (chmin(min_rect_size, rect_size)) {
-            face_index = i;
-         }
-      }
+void FaceGroup::UpdateFaceHeap(int face_index) {
+   const auto& face = face_list_[face_index];
 
-      if (face_index != -1) {
-         // debug(face_index, max_b, face_list_[face_index].GetEdgeList());
-         break;
-      }
+   // 未選択の辺がD本以下(スケジュール内で連結性を保つため)のものが選択候補
+   if (face_bit_[face_index] || face.UnselectedCount() > D_) {
+      face_heap_.Erase(face_index);
+      return;
    }
 
+   // Edge Betweennessの大きいもの, 矩形サイズが小さいものから選択
+   face_heap_.Set(face_index, FaceKey(-face.MaxBetweenness(), face.RectSize(), face_index));
+}
+
+vector<int> FaceGroup::Greedy() {
    vector<int> face_index_list;  // face_indexのリスト
 
-   if (face_index == -1) {
+   if (face_heap_.Empty()) {
       return face_index_list;
    }
 
+   int face_index = face_heap_.Top();
+
    using FaceEdgeCnt = pair<int, int>;
    vector<FaceEdgeCnt> face_edge_cnt_list;
+   GrowingFaceGroup face_group;
 
    auto add_index = [&](int index) {
       face_edge_cnt_list.emplace_back(face_list_[index].UnselectedCount(), index);
-      face_index_list.emplace_back(index);
+      AddFace(face_group, index);
       face_bit_[index] = 1;
+      face_heap_.Erase(index);
    };
 
    add_index(face_index);
@@ -339,7 +316,7 @@ vector<int> FaceGroup::Greedy() {
 
    for (auto adj_face_index : face_adj_list_[face_index]) {
       if (face_bit_[adj_face_index]) continue;
-      // debug(face_index, adj_face_index, CanFaceGroup(face_index_list, adj_face_index));
+      // debug(face_index, adj_face_index, CanFaceGroup(face_group, adj_face_index));
       int max_bet = face_list_[adj_face_index].MaxBetweenness();
       max_bet_face_list.emplace_back(max_bet, adj_face_index);
    }
@@ -347,16 +324,17 @@ vector<int> FaceGroup::Greedy() {
    sort(max_bet_face_list.rbegin(), max_bet_face_list.rend());
 
    for (auto [max_b, adj_face_index] : max_bet_face_list) {
-      // debug(max_b, adj_face_index, CanFaceGroup(face_index_list, adj_face_index));
+      // debug(max_b, adj_face_index, CanFaceGroup(face_group, adj_face_index));
 
-      if (CanFaceGroup(face_index_list, adj_face_index)) {
+      if (CanFaceGroup(face_group, adj_face_index)) {
          add_index(adj_face_index);
       }
    }
 
    // 辺数の昇順にソート
    sort(face_edge_cnt_list.begin(), face_edge_cnt_list.end());
-   assert(face_edge_cnt_list.size() == face_index_list.size());
+   assert(face_edge_cnt_list.size() == face_group.face_index_list.size());
+   face_index_list.resize(face_edge_cnt_list.size());
 
    rep(i, face_edge_cnt_list.size()) {
       face_index_list[i] = face_edge_cnt_list[i].second;
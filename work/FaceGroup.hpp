@@ -7,6 +7,7 @@
 #include <set>
 
 #include "Graph.hpp"
+#include "IndexedHeap.hpp"
 
 // 面
 using EdgeBetween = std::pair<int, int>;      // edge betweenness, edge_index
@@ -14,29 +15,37 @@ using Rect = std::tuple<int, int, int, int>;  // [min_x, min_y, max_x, max_y]
 
 class Face {
   public:
-   Face(const Graph& graph, const std::vector<Node>& node_list);
+   // edge_index_list[k]はnode_list[k]とnode_list[k + 1](末尾は先頭)を結ぶ辺
+   Face(const Graph& graph, const std::vector<Node>& node_list, const std::vector<int>& edge_index_list);
 
    int EdgeCount() const {
       return edge_list_.size();
    }
 
    int UnselectedCount() const {
-      return unselected_.size();
+      return unselected_count_;
    }
 
    // 未選択の辺の最大edge betweennessを返す
-   int MaxBetweenness() const;
+   // 計算量: O(1)
+   int MaxBetweenness() const {
+      return max_pos_ < (int)edge_list_.size() ? edge_list_[max_pos_].first : 0;
+   }
 
+   // 計算量: O(面の辺数)
    void Select(const int e);
 
-   bool IsAdjacent(const Face& face) const;
-
    const std::vector<EdgeBetween>& GetEdgeList() const {
       return edge_list_;
    }
 
-   // 未選択の辺リストを返す
-   std::vector<EdgeBetween> GetUnselectedEdgeList() const;
+   // 未選択の辺(edge betweenness, edge index)をedge betweennessの降順に列挙する
+   template <class F>
+   void ForEachUnselected(F func) const {
+      for (int i = 0; i < (int)edge_list_.size(); i++) {
+         if (!selected_[i]) func(edge_list_[i].first, edge_list_[i].second);
+      }
+   }
 
    // 矩形を返す
    const Rect& GetRect() const {
@@ -51,15 +60,23 @@ class Face {
 
    Rect rect_;  // 面を含む矩形領域
 
-   std::set<int> selected_;
-   std::set<int> unselected_;
-
    std::vector<EdgeBetween> edge_list_;  // 辺集合, edge betweennessの降順にソート
+   std::vector<char> selected_;          // selected_[i]: edge_list_[i]が選択済か
+
+   int unselected_count_;  // 未選択の辺数(面の境界に2回現れる辺は1本と数える)
+   int max_pos_;           // 未選択の辺のうちedge_list_での先頭位置
 };
 
 using Faces = std::vector<Face>;
 using FaceBit = std::bitset<2510>;  // F = 2 + M - N <= 2 + 3000 - 500
 
+// Greedyで拡大中の面集合
+struct GrowingFaceGroup {
+   std::vector<int> face_index_list;  // 面indexのリスト
+   FaceBit member_bit;                // 面集合に含まれる面
+   Rect rect{1001, 1001, -1, -1};     // 面集合を含む矩形領域
+};
+
 class FaceGroup
     : public Graph {
   public:
@@ -67,7 +84,8 @@ class FaceGroup
    std::vector<Faces> MakeGroup();
 
    // Faceを連結できるか判定する
-   bool CanFaceGroup(const std::vector<int>& face_index, int adj_face_index) const;
+   // 計算量: O(adj_face_indexの辺数)
+   bool CanFaceGroup(const GrowingFaceGroup& face_group, int adj_face_index) const;
 
   protected:
    // GreedyにFace集合を拡大する
@@ -75,11 +93,22 @@ class FaceGroup
    std::vector<int> Greedy();
    void GenerateFaces();
 
+   // 面集合に面を追加する
+   void AddFace(GrowingFaceGroup& face_group, int face_index) const;
+
+   // 面の選択候補のキーを更新する
+   // 計算量: O(log F)
+   void UpdateFaceHeap(int face_index);
+
    int D_;
 
-   std::vector<std::vector<int>> face_adj_list_;  // 面の隣接リスト
+   std::vector<std::vector<int>> face_adj_list_;      // 面の隣接リスト
+   std::vector<std::vector<int>> edge_to_face_index_;  // 辺 -> 面index
 
-   std::map<int, std::set<int>> face_max_bet_map_;  // max_bet -> face index set
+   // 選択候補の面(未使用かつ未選択の辺がD本以下)
+   // キー: (-max betweenness, 矩形サイズ, face index)の昇順
+   using FaceKey = std::tuple<int, int, int>;
+   IndexedHeap<FaceKey> face_heap_;
 
    FaceBit face_bit_;  // 選択済みのFace bit
 
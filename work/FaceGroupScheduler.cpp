@@ -34,6 +34,8 @@ void FaceGroupScheduler::InitializeRandom() {
       if (avail_cnt[e] == 1) avail_one_edge_[e] = 1;
    }
 
+   bypass_set_.SetAvailOneEdge(avail_one_edge_);
+
    // 初期集合を作る
    rep(e, E) {
       vector<int> day_list;
@@ -72,6 +74,8 @@ void FaceGroupScheduler::Initialize() {
       if (avail_cnt[e] == 1) avail_one_edge_[e] = 1;
    }
 
+   bypass_set_.SetAvailOneEdge(avail_one_edge_);
+
    // 初期集合を作る
    EdgeBit scheduled;
 
@@ -384,9 +388,9 @@ FaceGroupSA_Trans FaceGroupScheduler::GenerateTransition() {
    if (bypass_set_.InBypassEdgeCount() > 0) {
       int rnd = XorShift() % 100;
       if (rnd < kBySetSA_DefaultSelectInBypass) {
-         e = bypass_set_.SelectInBypassEdge(avail_one_edge_);
+         e = bypass_set_.SelectInBypassEdge();
       } else {
-         e = bypass_set_.SelectBypassGeneratorEdge(avail_one_edge_);
+         e = bypass_set_.SelectBypassGeneratorEdge();
       }
    } else {
       while (true) {
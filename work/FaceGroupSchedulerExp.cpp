@@ -7,6 +7,7 @@
 #include "UnionFind.hpp"
 #include "XorShift.hpp"
 #include "ShortestTree.hpp"
+#include "Profile.hpp"
 
 #include "debug.hpp"
 
@@ -20,7 +21,7 @@ template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} retu
 // clang-format on
 
 FaceGroupSchedulerExp::FaceGroupSchedulerExp(int M, int D, int K, const Graph &graph, const vector<Faces> &face_group_list)
-    : graph_(graph), M_(M), D_(D), K_(K), face_group_list_(face_group_list), mt_(1234), max_temp_(kFaceGroupExpSA_DefaultMaxTemp), min_temp_(kFaceGroupExpSA_DefaultMinTemp), edge_day_(M, -1), day_construction_count_(D, 0), day_cost_(D, 0), iter_count_(0) {
+    : graph_(graph), M_(M), D_(D), K_(K), face_group_list_(face_group_list), mt_(1234), max_temp_(kFaceGroupExpSA_DefaultMaxTemp), min_temp_(kFaceGroupExpSA_DefaultMinTemp), edge_day_(M, -1), day_construction_count_(D, 0), day_cost_(D, 0), time_limit_ms_(0), iter_count_(0), exact_eval_(false), shortest_forest_(graph, D), union_find_(graph.GetNodeSize()) {
    start_time_ = chrono::system_clock::now();
 
    auto n1 = graph_.GetCoordNode(0, 0);
@@ -54,6 +55,8 @@ int FaceGroupSchedulerExp::ElapsedTime() {
 }
 
 void FaceGroupSchedulerExp::Initialize() {
+   PROFILE_SCOPE("FaceGroupSchedulerExp::Initialize");
+
    // 初期集合を作る
    EdgeBit scheduled;
 
@@ -206,6 +209,11 @@ void FaceGroupSchedulerExp::Initialize() {
       }
    }
 
+   if (exact_eval_) {
+      shortest_forest_.Init(edge_day_);
+      return;
+   }
+
    auto graph_edge_list = graph_.GetEdgeList();
 
    rep(d, D_) {
@@ -339,9 +347,18 @@ long long FaceGroupSchedulerExp::CalcEstimCostByPoints(int target_e, int from_d,
    return before_cost - after_cost;
 }
 
+long long FaceGroupSchedulerExp::CalcExactCost(int target_e, int from_d, int to_d) {
+   auto delta = shortest_forest_.MoveEdge(target_e, from_d, to_d, true);
+
+   if (delta <= 0) {
+      shortest_forest_.Undo();
+   }
+
+   return delta;
+}
+
 void FaceGroupSchedulerExp::AdjustMaxConst(int from_d, int to_d, bool randomize_tree, bool force_e) {
    int E = graph_.GetEdgeList().size();
-   int N = graph_.GetNodeSize();
    // from_dから削除する
    vector<EdgeBetween> from_d_edge;
    rep(e, E) {
@@ -354,7 +371,9 @@ void FaceGroupSchedulerExp::AdjustMaxConst(int from_d, int to_d, bool randomize_
    // edge bvetweennessの小さいものを移す
    sort(from_d_edge.begin(), from_d_edge.end());
 
-   UnionFind uf(N);
+   auto &uf = union_find_;
+   uf.Reset();
+
    // to_dで全域木を求め、削除可能な辺を求める
    vector<EdgeBetween> edge_list;
    rep(e, E) {
@@ -386,7 +405,7 @@ void FaceGroupSchedulerExp::AdjustMaxConst(int from_d, int to_d, bool randomize_
 
       uf.Unite(u, v);
 
-      if ((int)uf.size(1) == N) {
+      if (uf.GroupCount() == 1) {
          for (int j = i + 1; j < (int)edge_list.size(); j++) {
             can_del_edge.insert(edge_list[j].second);
          }
@@ -689,6 +708,8 @@ pair<int, EdgeBit> FaceGroupSchedulerExp::CalcMaxPriorityDay(const EdgeBit &sche
 }
 
 vector<int> FaceGroupSchedulerExp::MakeSchedule(int sche_face_group) {
+   PROFILE_SCOPE("FaceGroupSchedulerExp::MakeSchedule");
+
    int E = graph_.GetEdgeList().size();
    sche_face_group_ = min(sche_face_group, (int)face_group_list_.size());
    uniform_real_distribution<> uniform_dist(0.0, 1.0);
@@ -697,6 +718,7 @@ vector<int> FaceGroupSchedulerExp::MakeSchedule(int sche_face_group) {
    int kMaxTime = 6 * 1000 - 250;
 
    if (E < 1500) kMaxTime = 6 * 1000 - 200;
+   if (time_limit_ms_ > 0) kMaxTime = time_limit_ms_;
 
    Initialize();
    long long cur_cost = 100000000;
@@ -724,9 +746,11 @@ vector<int> FaceGroupSchedulerExp::MakeSchedule(int sche_face_group) {
       }
 
       // 遷移
+      PROFILE_COUNT("SA.proposals", 1);
       auto [trans_e, from_d, to_d] = GenerateTransition(i);
 
       if (from_d == to_d) {
+         PROFILE_COUNT("SA.same_day", 1);
          continue;
       }
 
@@ -736,7 +760,12 @@ vector<int> FaceGroupSchedulerExp::MakeSchedule(int sche_face_group) {
       }
 
       // auto estim_delta = CalcEstimCost(trans_e, from_d, to_d);
-      auto estim_delta = CalcEstimCostByPoints(trans_e, from_d, to_d);
+      long long estim_delta = 0;
+
+      {
+         PROFILE_SCOPE("SA.estimate");
+         estim_delta = exact_eval_ ? CalcExactCost(trans_e, from_d, to_d) : CalcEstimCostByPoints(trans_e, from_d, to_d);
+      }
       bool search_update = false;
 
       if (estim_delta > 0) {
@@ -748,10 +777,12 @@ vector<int> FaceGroupSchedulerExp::MakeSchedule(int sche_face_group) {
 
       if (!search_update) {
          // 元に戻す
+         PROFILE_COUNT("SA.rejected", 1);
          skip_cnt++;
          continue;
       }
 
+      PROFILE_COUNT("SA.accepted", 1);
       MakeTrans(trans_e, from_d, to_d);
 
       // debug(i, delta_improve, estim_delta);
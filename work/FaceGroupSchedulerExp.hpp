@@ -6,6 +6,8 @@
 #include <chrono>
 
 #include "ShortestTree.hpp"
+#include "ShortestForest.hpp"
+#include "UnionFind.hpp"
 #include "FaceGroup.hpp"
 #include "BypassSet.hpp"
 using EdgePriority = std::pair<long long, int>;
@@ -34,6 +36,17 @@ class FaceGroupSchedulerExp {
       return iter_count_;
    }
 
+   // 代表点による推定ではなく全点の最短路木による厳密なコスト差分で焼きなます
+   void SetExactEval(bool exact_eval) {
+      exact_eval_ = exact_eval;
+   }
+
+   // 焼きなましの制限時間(ms, コンストラクタからの経過時間)を設定する
+   // 0の場合は辺数から決める
+   void SetTimeLimit(int time_limit_ms) {
+      time_limit_ms_ = time_limit_ms;
+   }
+
   protected:
    // 工事予定日を初期化する
    void Initialize();
@@ -60,6 +73,7 @@ class FaceGroupSchedulerExp {
 
    long long CalcEstimCost(int e, int from_d, int to_d);
    long long CalcEstimCostByPoints(int e, int from_d, int to_d);
+   long long CalcExactCost(int e, int from_d, int to_d);
 
    void MinDistCheck();
 
@@ -88,9 +102,15 @@ class FaceGroupSchedulerExp {
    std::vector<long long> day_cost_;  // 日別のコスト
 
    std::chrono::system_clock::time_point start_time_;
+   int time_limit_ms_;  // 焼きなましの制限時間(ms, 0: 辺数から決める)
 
    int iter_count_;
 
    std::vector<Node> rep_point_list_;                      // 代表点
    std::vector<std::vector<ShortestTree>> min_dist_tree_;  // 日別代表点別の最短路木
+
+   bool exact_eval_;                 // 厳密なコスト差分で評価するか
+   ShortestForest shortest_forest_;  // 日別全点の最短路木(exact_eval_時のみ構築)
+
+   UnionFind union_find_;  // AdjustMaxConstの作業領域
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <queue>
 
 #include "Graph.hpp"
+#include "Profile.hpp"
 
 using namespace std;
 
@@ -21,6 +22,7 @@ Graph::Graph(int N)
    node_shortest_tree_.resize(N + 1);
 
    adj_list_.resize(N + 1);
+   sorted_neighbor_.resize(N + 1);
 
    node_coord_.resize(N + 1);
 }
@@ -30,6 +32,16 @@ void Graph::AddEdge(int u, int v, ll w) {
    adj_list_[u].emplace_back(i, v, w);
    adj_list_[v].emplace_back(i, u, w);
 
+   // 隣接ノードの昇順を保つように挿入する
+   auto insert_neighbor = [&](Node from, Node to) {
+      auto& neighbor = sorted_neighbor_[from];
+      auto it = lower_bound(neighbor.begin(), neighbor.end(), NeighborEdge(to, -1));
+      neighbor.emplace(it, to, i);
+   };
+
+   insert_neighbor(u, v);
+   insert_neighbor(v, u);
+
    edge_list_.emplace_back(u, v, w);
 }
 
@@ -97,11 +109,23 @@ EdgeBit FindShortestPath(const int start, const int end, const vector<vector<Adj
    return path_bit;
 }
 
-void Graph::Prep(bool calc_bypass) {
+void Graph::Prep(bool calc_bypass, bool calc_edge_cost, bool calc_edge_pair) {
+   PROFILE_SCOPE("Graph::Prep");
+
    EdgeBit del_edge_flg;
    edge_bypass_.resize(edge_list_.size());
+   edge_bypass_rev_.resize(edge_list_.size());
    edge_betweenness_.resize(edge_list_.size(), 0);
 
+   if (calc_edge_cost) {
+      edge_cost_dist_.assign(edge_list_.size(), 0);
+      edge_discon_count_.assign(edge_list_.size(), 0);
+   }
+
+   if (calc_edge_pair) {
+      edge_pair_bit_.assign(edge_list_.size(), EdgeBit());
+   }
+
    for (Node s = 1; s <= N_; s++) {
       auto min_dist = ShortestPathBFS(adj_list_, s, del_edge_flg);
 
@@ -113,7 +137,25 @@ void Graph::Prep(bool calc_bypass) {
 
       node_sum_dist_[s] = node_dist;
 
-      SetShortestTree(s, s, -1, min_dist);
+      SetShortestTree(s, min_dist);
+
+      // 辺を1本削除した時のコストは最短路木に含まれる始点のみ変わる
+      if (calc_edge_cost) AddEdgeCost(s, min_dist, calc_edge_pair);
+   }
+
+   // 相互作用は対称なので、片方の辺からのみ見つかったペアも追加する
+   if (calc_edge_pair) {
+      rep(e, edge_list_.size()) {
+         const auto& pair_bit = edge_pair_bit_[e];
+
+         for (int p = pair_bit._Find_first(); p < (int)pair_bit.size(); p = pair_bit._Find_next(p)) {
+            edge_pair_bit_[p][e] = 1;
+         }
+      }
+
+      rep(e, edge_list_.size()) {
+         edge_pair_bit_[e][e] = 0;
+      }
    }
 
    // 辺eを削除した場合の迂回路を求める
@@ -128,6 +170,15 @@ void Graph::Prep(bool calc_bypass) {
 
          del_edge_flg[e] = 0;
       }
+
+      // 迂回路の逆引き
+      rep(e, edge_list_.size()) {
+         const auto& bypass_bit = edge_bypass_[e];
+
+         for (int p = bypass_bit._Find_first(); p < (int)bypass_bit.size(); p = bypass_bit._Find_next(p)) {
+            edge_bypass_rev_[p][e] = 1;
+         }
+      }
    }
 }
 
@@ -208,6 +259,11 @@ std::pair<long long, int> Graph::CalcCostNode(int node, const std::vector<int>&
 }
 
 pair<ll, int> Graph::CalcCost(const std::vector<int>& del_edge_list) const {
+   auto [cost, disconnected_count] = CalcCostDist(del_edge_list);
+   return {1000LL * cost / (N_ * (N_ - 1)), disconnected_count};
+}
+
+pair<ll, int> Graph::CalcCostDist(const std::vector<int>& del_edge_list) const {
    EdgeBit del_edge_flg;
 
    for (auto e : del_edge_list) {
@@ -243,7 +299,7 @@ pair<ll, int> Graph::CalcCost(const std::vector<int>& del_edge_list) const {
       cost += node_dist - node_sum_dist_[s];
    }
 
-   return {1000LL * cost / (N_ * (N_ - 1)), disconnected_count};
+   return {cost, disconnected_count};
 }
 
 pair<long long, int> Graph::CalcScheduleCost(int D, const std::vector<int>& schedule) const {
@@ -310,37 +366,231 @@ long long Graph::CalcEdgeSqDist(const Edge& edge_1, const Edge& edge_2) const {
    return edge_dist;
 }
 
-int Graph::SetShortestTree(Node start, Node node, Node p, const std::vector<long long>& min_dist) {
-   int total_child_cnt = 0;
+void Graph::SetShortestTree(Node start, const std::vector<long long>& min_dist) {
+   auto& parent_edge = tree_parent_edge_;
+   auto& child_begin = tree_child_begin_;
+   auto& order = tree_order_;
+
+   parent_edge.assign(N_ + 1, -1);
+   child_begin.assign(N_ + 2, 0);
+
+   // 各ノードの親を1つに決める
+   for (Node node = 1; node <= N_; node++) {
+      if (node == start || min_dist[node] == DIST_INF) continue;
+
+      for (auto [edge_index, p_node, w] : adj_list_[node]) {
+         if (min_dist[p_node] + w != min_dist[node]) continue;
+
+         parent_edge[node] = edge_index;
+         child_begin[p_node + 1]++;
+         node_shortest_tree_[start].set(edge_index);
+         break;
+      }
+   }
+
+   auto parent = [&](Node node) {
+      auto [u, v, w] = edge_list_[parent_edge[node]];
+      return u ^ v ^ node;
+   };
 
-   for (auto [edge_index, n_node, w] : adj_list_[node]) {
-      if (n_node == p) continue;
+   // 子ノードをまとめ、根からBFS順に並べる
+   for (Node node = 1; node <= N_ + 1; node++) {
+      child_begin[node] += child_begin[node - 1];
+   }
+
+   auto& child = tree_child_;
+   auto& child_cnt = tree_child_cnt_;
 
-      if (min_dist[n_node] != min_dist[node] + w) continue;
-      node_shortest_tree_[start].set(edge_index);
+   // 子の書き込み位置(部分木のノード数の集計前に作業領域として使う)
+   child.resize(N_);
+   child_cnt.assign(child_begin.begin(), child_begin.end() - 1);
 
-      int child_cnt = SetShortestTree(start, n_node, node, min_dist);
-      total_child_cnt += child_cnt;
+   for (Node node = 1; node <= N_; node++) {
+      if (parent_edge[node] != -1) child[child_cnt[parent(node)]++] = node;
    }
 
-   total_child_cnt++;  // 自分を含める
+   order.clear();
+   order.emplace_back(start);
 
-   if (p != -1) {
-      auto e = GetEdgeIndex(node, p);
+   rep(i, order.size()) {
+      Node node = order[i];
 
-      // 自身と親の辺はtotal_child_cnt回通る
-      edge_betweenness_[e] += total_child_cnt;
+      for (int j = child_begin[node]; j < child_begin[node + 1]; j++) {
+         order.emplace_back(child[j]);
+      }
    }
 
-   return total_child_cnt;
+   // BFS順の逆順に部分木のノード数を集計する
+   child_cnt.assign(N_ + 1, 1);  // 自分を含めた部分木のノード数
+
+   for (int i = (int)order.size() - 1; i > 0; i--) {
+      Node node = order[i];
+
+      // 自身と親の辺はchild_cnt回通る
+      edge_betweenness_[parent_edge[node]] += child_cnt[node];
+      child_cnt[parent(node)] += child_cnt[node];
+   }
 }
-const int Graph::GetEdgeIndex(Node u, Node v) const {
-   for (auto [edge_index, to, w] : adj_list_[u]) {
-      if (to == v) return edge_index;
+
+void Graph::AddEdgeCost(Node start, const std::vector<long long>& min_dist, bool calc_edge_pair) {
+   const auto& parent_edge = tree_parent_edge_;
+   const auto& child_begin = tree_child_begin_;
+   const auto& child = tree_child_;
+   const auto& child_cnt = tree_child_cnt_;
+
+   auto& preorder = tree_preorder_;
+   auto& preorder_index = tree_preorder_index_;
+   auto& repair_dist = repair_dist_;
+   auto& heap = repair_heap_;
+   auto& repair_parent_edge = repair_parent_edge_;
+   auto& repair_parent = repair_parent_;
+
+   // 行きがけ順に並べ、各部分木をpreorderの連続区間にする
+   preorder.clear();
+   preorder_index.assign(N_ + 1, -1);
+   repair_dist.resize(N_ + 1);
+   repair_parent_edge.resize(N_ + 1);
+   repair_parent.resize(N_ + 1);
+
+   vector<Node> stack{start};
+
+   while (!stack.empty()) {
+      Node node = stack.back();
+      stack.pop_back();
+
+      preorder_index[node] = preorder.size();
+      preorder.emplace_back(node);
+
+      for (int j = child_begin[node]; j < child_begin[node + 1]; j++) {
+         stack.emplace_back(child[j]);
+      }
    }
 
-   assert(false);
-   return -1;
+   // 辺ペアの相互作用が0でないのは、ある終点tについて以下のいずれかが成り立つ場合のみ
+   // - tへの最短路木上のパスに両方の辺が含まれる(一方が他方の祖先)
+   // - 一方の辺のみパスに含まれ、その辺を削除した時の(求め直した)最短路にもう一方の辺が含まれる
+   auto& path_bit = tree_path_bit_;
+   auto& desc_bit = tree_desc_bit_;
+
+   if (calc_edge_pair) {
+      path_bit.resize(N_ + 1);
+      desc_bit.resize(N_ + 1);
+
+      for (auto node : preorder) {
+         desc_bit[node].reset();
+      }
+
+      path_bit[start].reset();
+
+      for (int i = 1; i < (int)preorder.size(); i++) {
+         Node node = preorder[i];
+         int e = parent_edge[node];
+         auto [u, v, w] = edge_list_[e];
+
+         path_bit[node] = path_bit[u ^ v ^ node];
+         path_bit[node].set(e);
+      }
+
+      for (int i = (int)preorder.size() - 1; i > 0; i--) {
+         Node node = preorder[i];
+         int e = parent_edge[node];
+         auto [u, v, w] = edge_list_[e];
+
+         auto& parent_desc = desc_bit[u ^ v ^ node];
+         parent_desc |= desc_bit[node];
+         parent_desc.set(e);
+      }
+   }
+
+   using DistNode = pair<long long, Node>;
+
+   for (int i = 1; i < (int)preorder.size(); i++) {
+      Node root = preorder[i];
+      int del_e = parent_edge[root];
+      int begin = i, end = i + child_cnt[root];
+
+      auto in_subtree = [&](Node node) {
+         int index = preorder_index[node];
+         return begin <= index && index < end;
+      };
+
+      // 部分木の外側から距離を確定させる
+      heap.clear();
+
+      for (int j = begin; j < end; j++) {
+         Node node = preorder[j];
+         repair_dist[node] = DIST_INF;
+
+         for (auto [edge_index, node_to, w] : adj_list_[node]) {
+            if (edge_index == del_e || in_subtree(node_to)) continue;
+            if (min_dist[node_to] == DIST_INF) continue;
+
+            if (chmin(repair_dist[node], min_dist[node_to] + w)) {
+               repair_parent_edge[node] = edge_index;
+               repair_parent[node] = node_to;
+            }
+         }
+
+         if (repair_dist[node] != DIST_INF) heap.emplace_back(repair_dist[node], node);
+      }
+
+      // 部分木の内側をダイクストラ法で更新する
+      make_heap(heap.begin(), heap.end(), greater<DistNode>());
+
+      while (!heap.empty()) {
+         pop_heap(heap.begin(), heap.end(), greater<DistNode>());
+         auto [dist, node] = heap.back();
+         heap.pop_back();
+
+         if (repair_dist[node] < dist) continue;
+
+         for (auto [edge_index, node_to, w] : adj_list_[node]) {
+            if (!in_subtree(node_to)) continue;
+
+            if (chmin(repair_dist[node_to], dist + w)) {
+               repair_parent_edge[node_to] = edge_index;
+               repair_parent[node_to] = node;
+               heap.emplace_back(repair_dist[node_to], node_to);
+               push_heap(heap.begin(), heap.end(), greater<DistNode>());
+            }
+         }
+      }
+
+      ll diff = 0;
+
+      for (int j = begin; j < end; j++) {
+         Node node = preorder[j];
+         diff += repair_dist[node] - min_dist[node];
+
+         if (repair_dist[node] == DIST_INF) edge_discon_count_[del_e]++;
+      }
+
+      edge_cost_dist_[del_e] += diff;
+
+      if (!calc_edge_pair) continue;
+
+      // 部分木内の各終点への最短路(部分木の外側は元の最短路木のパス)の和集合
+      auto& pair_bit = edge_pair_bit_[del_e];
+      pair_bit |= path_bit[root];
+      pair_bit |= desc_bit[root];
+
+      for (int j = begin; j < end; j++) {
+         Node node = preorder[j];
+         if (repair_dist[node] == DIST_INF) continue;
+
+         pair_bit.set(repair_parent_edge[node]);
+
+         if (!in_subtree(repair_parent[node])) pair_bit |= path_bit[repair_parent[node]];
+      }
+   }
+}
+
+const int Graph::GetEdgeIndex(Node u, Node v) const {
+   const auto& neighbor = sorted_neighbor_[u];
+   auto it = lower_bound(neighbor.begin(), neighbor.end(), NeighborEdge(v, -1));
+
+   assert(it != neighbor.end() && it->first == v);
+   return it->second;
 }
 
 Node Graph::GetCenterNode() const {
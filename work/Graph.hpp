@@ -40,7 +40,9 @@ class Graph {
    // - 2ノード間距離の総和を求める
    // - 最短路木を求める
    // - Edge betweennessを求める
-   void Prep(bool calc_bypass);
+   // - calc_edge_cost = trueの場合、各辺を1本削除した時の不満度を求める
+   // - calc_edge_pair = trueの場合、同時に削除すると相互作用が生じうる辺ペアを求める(calc_edge_cost = trueが必要)
+   void Prep(bool calc_bypass, bool calc_edge_cost = false, bool calc_edge_pair = false);
 
    // 辺を削除した時の不満度と非連結なノードペア数を求める
    std::pair<long long, int> CalcCost(const std::vector<int>& del_edge_index_list) const;
@@ -48,6 +50,9 @@ class Graph {
    std::pair<long long, int> CalcCostNode(int node, const std::vector<int>& del_edge_index_list) const;
    std::pair<long long, int> CalcScheduleCost(int D, const std::vector<int>& schedule) const;
 
+   // 辺を削除した時の距離の総和の増加量(不満度に換算する前の値)と非連結なノードペア数を求める
+   std::pair<long long, int> CalcCostDist(const std::vector<int>& del_edge_index_list) const;
+
    // ノード間の平方距離
    long long CalcNodeSqDist(Node u, Node v) const;
    long long CalcEdgeSqDist(const Edge& edge_1, const Edge& edge_2) const;
@@ -60,8 +65,27 @@ class Graph {
       return edge_bypass_[e];
    }
 
+   const EdgeBit& GetBypassRevBit(const int e) const {
+      return edge_bypass_rev_[e];
+   }
+
+   // ノードu, vを結ぶ辺のedge indexを返す
+   // 計算量: O(log deg(u))
    const int GetEdgeIndex(Node u, Node v) const;
 
+   // 辺eのみを削除した時の不満度と非連結なノードペア数(CalcCost({e})と同じ値)を返す
+   // @pre Prep(*, true)を実行済であること
+   std::pair<long long, int> GetEdgeCost(int e) const {
+      return {1000LL * edge_cost_dist_[e] / (N_ * (N_ - 1)), edge_discon_count_[e]};
+   }
+
+   // 辺eと同時に削除した時に相互作用(ペアのコスト - 各辺単独のコストの和)が0でない可能性がある辺の集合を返す
+   // - 集合に含まれない辺とのペアの相互作用は必ず0になる
+   // @pre Prep(*, true, true)を実行済であること
+   const EdgeBit& GetEdgePairBit(int e) const {
+      return edge_pair_bit_[e];
+   }
+
    int GetEdgeBetweenness(int e) const {
       return edge_betweenness_[e];
    }
@@ -72,18 +96,52 @@ class Graph {
 
    int N_;
 
-   // 最短路木を構築する
-   int SetShortestTree(Node start, Node node, Node p, const std::vector<long long>& min_dist);
+   // startを根とする最短路木の各辺について、削除した時の距離の増加量を加算する
+   // - 距離が変わるのは削除した辺の子の部分木のみなので、部分木内で距離を求め直す
+   // - calc_edge_pair = trueの場合、相互作用が生じうる辺ペアをedge_pair_bit_に追加する
+   // 計算量: O(Σ部分木の(ノード数 + 辺数) log N), calc_edge_pair = trueの場合はO(Σ部分木のノード数 * M / 64)を加算
+   // @pre SetShortestTree(start, min_dist)を実行済であること
+   void AddEdgeCost(Node start, const std::vector<long long>& min_dist, bool calc_edge_pair = false);
+
+   // startを根とする最短路木を構築し、edge betweennessに加算する
+   // - 各ノードの親は1つに決める(距離が同じ親候補が複数ある場合は隣接リストで先頭のもの)
+   // - BFS順の逆順に部分木のノード数を親へ足し込む
+   // 計算量: O(N + E)
+   void SetShortestTree(Node start, const std::vector<long long>& min_dist);
 
    long long total_dist_;                     // ノード間距離の総和
    std::vector<long long> node_sum_dist_;     // node_sum_dist_[n]: ノードnからの距離の総和
    std::vector<EdgeBit> node_shortest_tree_;  // node_shortest_tree_[n]: ノードnの最短路木
 
-   std::vector<EdgeBit> edge_bypass_;   // edge_bypass_[e]: 辺eを削除した際の迂回路(edge indexの集合)
-   std::vector<int> edge_betweenness_;  // edge_betweenness_[e]: 辺eのedge betweenness
+   std::vector<EdgeBit> edge_bypass_;       // edge_bypass_[e]: 辺eを削除した際の迂回路(edge indexの集合)
+   std::vector<EdgeBit> edge_bypass_rev_;   // edge_bypass_rev_[e]: 迂回路に辺eを含む辺の集合
+   std::vector<int> edge_betweenness_;      // edge_betweenness_[e]: 辺eのedge betweenness
+   std::vector<long long> edge_cost_dist_;  // edge_cost_dist_[e]: 辺eのみを削除した時の距離の総和の増加量
+   std::vector<int> edge_discon_count_;     // edge_discon_count_[e]: 辺eのみを削除した時の非連結なノードペア数
+   std::vector<EdgeBit> edge_pair_bit_;     // edge_pair_bit_[e]: 辺eとの相互作用が0でない可能性がある辺の集合
 
    std::vector<Edge> edge_list_;             // 辺リスト
    std::vector<std::vector<Adj>> adj_list_;  // 隣接リスト
 
+   using NeighborEdge = std::pair<Node, int>;                // 隣接ノード, edge index
+   std::vector<std::vector<NeighborEdge>> sorted_neighbor_;  // sorted_neighbor_[u]: 隣接ノードの昇順
+
    std::vector<Coord> node_coord_;  // ノードの座標
+
+   // SetShortestTreeの作業領域
+   std::vector<int> tree_parent_edge_;  // 親との辺のedge index(-1: 根または到達不能)
+   std::vector<int> tree_child_begin_;  // ノードuの子はtree_child_[tree_child_begin_[u], tree_child_begin_[u + 1])
+   std::vector<Node> tree_child_;       // 親ごとにまとめた子ノード
+   std::vector<Node> tree_order_;       // 根からのBFS順
+   std::vector<int> tree_child_cnt_;    // 部分木のノード数
+
+   // AddEdgeCostの作業領域
+   std::vector<Node> tree_preorder_;                      // 根からの行きがけ順(部分木が連続する)
+   std::vector<int> tree_preorder_index_;                 // tree_preorder_でのノードの位置(-1: 到達不能)
+   std::vector<long long> repair_dist_;                   // 部分木内で求め直した距離
+   std::vector<std::pair<long long, Node>> repair_heap_;  // (距離, ノード)のmin heap
+   std::vector<int> repair_parent_edge_;                  // 求め直した最短路木での親との辺のedge index
+   std::vector<Node> repair_parent_;                      // 求め直した最短路木での親ノード
+   std::vector<EdgeBit> tree_path_bit_;                   // tree_path_bit_[u]: 根からノードuへの最短路木上のパス
+   std::vector<EdgeBit> tree_desc_bit_;                   // tree_desc_bit_[u]: ノードuの部分木に含まれる辺
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+// 0以上N未満の整数をキーの昇順に取り出すヒープ
+// 要素ごとの位置を保持し、キーの変更・削除をO(log N)で行う
+template <class Key>
+class IndexedHeap {
+  public:
+   IndexedHeap(int N = 0)
+       : key_(N), pos_(N, -1) {
+   }
+
+   // xをキーkeyで追加する(追加済の場合はキーを変更する)
+   void Set(int x, const Key& key) {
+      key_[x] = key;
+
+      if (pos_[x] == -1) {
+         pos_[x] = heap_.size();
+         heap_.emplace_back(x);
+      }
+
+      Up(pos_[x]);
+      Down(pos_[x]);
+   }
+
+   void Erase(int x) {
+      if (pos_[x] == -1) return;
+
+      int p = pos_[x];
+      Swap(p, heap_.size() - 1);
+      heap_.pop_back();
+      pos_[x] = -1;
+
+      if (p < (int)heap_.size()) {
+         Up(p);
+         Down(p);
+      }
+   }
+
+   bool Contains(int x) const {
+      return pos_[x] != -1;
+   }
+
+   bool Empty() const {
+      return heap_.empty();
+   }
+
+   // キーが最小の要素を返す
+   int Top() const {
+      return heap_[0];
+   }
+
+  private:
+   void Swap(int i, int j) {
+      std::swap(heap_[i], heap_[j]);
+      pos_[heap_[i]] = i;
+      pos_[heap_[j]] = j;
+   }
+
+   void Up(int i) {
+      while (i > 0) {
+         int p = (i - 1) / 2;
+         if (!(key_[heap_[i]] < key_[heap_[p]])) break;
+
+         Swap(i, p);
+         i = p;
+      }
+   }
+
+   void Down(int i) {
+      int n = heap_.size();
+
+      while (true) {
+         int c = 2 * i + 1;
+         if (c >= n) break;
+         if (c + 1 < n && key_[heap_[c + 1]] < key_[heap_[c]]) c++;
+         if (!(key_[heap_[c]] < key_[heap_[i]])) break;
+
+         Swap(i, c);
+         i = c;
+      }
+   }
+
+   std::vector<Key> key_;   // key_[x]: xのキー
+   std::vector<int> heap_;  // 二分ヒープ
+   std::vector<int> pos_;   // pos_[x]: heap_中のxの位置(-1: ヒープに含まれない)
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+// 0以上N未満の整数の集合
+// 追加・削除・添字によるアクセスをO(1)で行う(ランダムな要素の選択用)
+class IndexedSet {
+  public:
+   IndexedSet(int N = 0)
+       : pos_(N, -1) {
+   }
+
+   void Insert(int x) {
+      if (pos_[x] != -1) return;
+
+      pos_[x] = list_.size();
+      list_.emplace_back(x);
+   }
+
+   void Erase(int x) {
+      if (pos_[x] == -1) return;
+
+      // 末尾の要素をxの位置に移す
+      int y = list_.back();
+      list_[pos_[x]] = y;
+      pos_[y] = pos_[x];
+
+      list_.pop_back();
+      pos_[x] = -1;
+   }
+
+   bool Contains(int x) const {
+      return pos_[x] != -1;
+   }
+
+   int Size() const {
+      return list_.size();
+   }
+
+   bool Empty() const {
+      return list_.empty();
+   }
+
+   // i番目の要素を返す(順序は不定)
+   int operator[](int i) const {
+      return list_[i];
+   }
+
+  private:
+   std::vector<int> list_;  // 要素のリスト
+   std::vector<int> pos_;   // pos_[x]: list_中のxの位置(-1: 集合に含まれない)
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+// 計測用のタイマー/カウンター/ヒストグラム
+// - -DPROFILEを指定した場合のみ有効(未指定の場合はマクロが空になり実行時のコストはない)
+// - 計測値はスレッドごとに持ち、レポート時に全スレッド分を合算する
+// - レポートはJSONで出力する
+//
+// 使い方:
+//   PROFILE_SCOPE("Graph::Prep");           // スコープを抜けるまでの時間を計測する
+//   PROFILE_COUNT("SA.accepted", 1);        // カウンターに加算する
+//   PROFILE_HIST("SA.repair_nodes", size);  // 値の分布を記録する(2のべき乗のバケット)
+//   PROFILE_REPORT("profile.json");         // レポートをファイルに出力する
+
+#ifdef PROFILE
+
+#include <array>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace profile {
+
+enum class Kind { kTimer,
+                  kCounter,
+                  kHistogram };
+
+static constexpr int kBucketSize = 64;
+
+// 計測値
+struct Stat {
+   long long count = 0;  // 記録回数
+   long long sum = 0;    // 合計(タイマーはns)
+   long long min = LLONG_MAX;
+   long long max = LLONG_MIN;
+
+   std::array<long long, kBucketSize> bucket{};  // bucket[b]: 値が[2^(b-1), 2^b)の回数(b = 0は0以下)
+
+   void Add(long long value) {
+      count++;
+      sum += value;
+
+      if (value < min) min = value;
+      if (value > max) max = value;
+   }
+
+   void AddHist(long long value) {
+      Add(value);
+      bucket[value <= 0 ? 0 : 64 - __builtin_clzll(value)]++;
+   }
+
+   void Merge(const Stat& stat) {
+      count += stat.count;
+      sum += stat.sum;
+
+      if (stat.min < min) min = stat.min;
+      if (stat.max > max) max = stat.max;
+
+      for (int b = 0; b < kBucketSize; b++) bucket[b] += stat.bucket[b];
+   }
+};
+
+class Registry {
+  public:
+   static Registry& Instance() {
+      static Registry registry;
+      return registry;
+   }
+
+   // 計測項目を登録し、idを返す(呼び出し箇所ごとに1回)
+   int Register(const char* name, Kind kind) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      name_list_.emplace_back(name, kind);
+      return (int)name_list_.size() - 1;
+   }
+
+   // 呼び出したスレッドの計測値を返す
+   Stat& Get(int id) {
+      auto& stat_list = Local().stat_list;
+
+      if (id >= (int)stat_list.size()) stat_list.resize(id + 1);
+      return stat_list[id];
+   }
+
+   // 全スレッドの計測値を合算してJSONで出力する
+   // @note 計測中の他スレッドがある場合は値が不正確になる(join後に呼ぶこと)
+   void Report(std::ostream& os) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      std::vector<Stat> total = retired_;
+      total.resize(name_list_.size());
+
+      for (auto local : live_) {
+         for (int i = 0; i < (int)local->stat_list.size(); i++) total[i].Merge(local->stat_list[i]);
+      }
+
+      // 同名の項目(複数箇所で記録したもの)はまとめる
+      auto merged = [&](Kind kind) {
+         std::vector<std::pair<std::string, Stat>> list;
+
+         for (int i = 0; i < (int)name_list_.size(); i++) {
+            auto& [name, k] = name_list_[i];
+            if (k != kind) continue;
+
+            bool found = false;
+
+            for (auto& [n, stat] : list) {
+               if (n == name) {
+                  stat.Merge(total[i]);
+                  found = true;
+               }
+            }
+
+            if (!found) list.emplace_back(name, total[i]);
+         }
+
+         return list;
+      };
+
+      auto write_list = [&](const char* key, Kind kind, auto write_stat) {
+         os << "\"" << key << "\":{";
+         bool first = true;
+
+         for (const auto& [name, stat] : merged(kind)) {
+            os << (first ? "" : ",") << "\"" << name << "\":";
+            write_stat(stat);
+            first = false;
+         }
+
+         os << "}";
+      };
+
+      os << "{";
+
+      write_list("timers", Kind::kTimer, [&](const Stat& stat) {
+         os << "{\"count\":" << stat.count << ",\"total_ms\":" << stat.sum / 1e6;
+
+         if (stat.count > 0) {
+            os << ",\"mean_us\":" << stat.sum / 1e3 / stat.count << ",\"min_us\":" << stat.min / 1e3 << ",\"max_us\":" << stat.max / 1e3;
+         }
+
+         os << "}";
+      });
+
+      os << ",";
+
+      write_list("counters", Kind::kCounter, [&](const Stat& stat) {
+         os << stat.sum;
+      });
+
+      os << ",";
+
+      write_list("histograms", Kind::kHistogram, [&](const Stat& stat) {
+         os << "{\"count\":" << stat.count << ",\"sum\":" << stat.sum;
+
+         if (stat.count > 0) {
+            os << ",\"min\":" << stat.min << ",\"max\":" << stat.max;
+         }
+
+         // 空でないバケットのみ[下限, 回数]で出力する
+         os << ",\"buckets\":[";
+         bool first = true;
+
+         for (int b = 0; b < kBucketSize; b++) {
+            if (stat.bucket[b] == 0) continue;
+
+            long long lower = b == 0 ? 0 : 1LL << (b - 1);
+            os << (first ? "" : ",") << "[" << lower << "," << stat.bucket[b] << "]";
+            first = false;
+         }
+
+         os << "]}";
+      });
+
+      os << "}" << std::endl;
+   }
+
+  private:
+   // スレッドごとの計測値(スレッド終了時にretired_へ合算する)
+   struct LocalData {
+      std::vector<Stat> stat_list;
+
+      LocalData() {
+         auto& registry = Instance();
+         std::lock_guard<std::mutex> lock(registry.mutex_);
+
+         registry.live_.emplace_back(this);
+      }
+
+      ~LocalData() {
+         auto& registry = Instance();
+         std::lock_guard<std::mutex> lock(registry.mutex_);
+
+         auto& retired = registry.retired_;
+         if (retired.size() < stat_list.size()) retired.resize(stat_list.size());
+
+         for (int i = 0; i < (int)stat_list.size(); i++) retired[i].Merge(stat_list[i]);
+
+         auto& live = registry.live_;
+
+         for (int i = 0; i < (int)live.size(); i++) {
+            if (live[i] == this) {
+               live.erase(live.begin() + i);
+               break;
+            }
+         }
+      }
+   };
+
+   static LocalData& Local() {
+      thread_local LocalData local;
+      return local;
+   }
+
+   std::mutex mutex_;
+   std::vector<std::pair<std::string, Kind>> name_list_;  // name_list_[id]: 計測項目の名前と種類
+   std::vector<LocalData*> live_;                         // 実行中のスレッドの計測値
+   std::vector<Stat> retired_;                            // 終了したスレッドの計測値の合計
+};
+
+// スコープを抜けるまでの時間を計測する
+class ScopedTimer {
+  public:
+   ScopedTimer(int id)
+       : id_(id), start_(std::chrono::steady_clock::now()) {
+   }
+
+   ~ScopedTimer() {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+      Registry::Instance().Get(id_).Add(ns);
+   }
+
+  private:
+   int id_;
+   std::chrono::steady_clock::time_point start_;
+};
+
+inline void WriteReport(const char* path) {
+   std::ofstream ofs(path);
+   Registry::Instance().Report(ofs);
+}
+
+}  // namespace profile
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_SCOPE(name)                                                                                                      \
+   static const int PROFILE_CONCAT(profile_id_, __LINE__) = profile::Registry::Instance().Register(name, profile::Kind::kTimer); \
+   profile::ScopedTimer PROFILE_CONCAT(profile_timer_, __LINE__)(PROFILE_CONCAT(profile_id_, __LINE__))
+
+#define PROFILE_COUNT(name, value)                                                                         \
+   do {                                                                                                    \
+      static const int profile_id = profile::Registry::Instance().Register(name, profile::Kind::kCounter); \
+      profile::Registry::Instance().Get(profile_id).Add(value);                                            \
+   } while (0)
+
+#define PROFILE_HIST(name, value)                                                                            \
+   do {                                                                                                      \
+      static const int profile_id = profile::Registry::Instance().Register(name, profile::Kind::kHistogram); \
+      profile::Registry::Instance().Get(profile_id).AddHist(value);                                          \
+   } while (0)
+
+#define PROFILE_REPORT(path) profile::WriteReport(path)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNT(name, value) \
+   do {                            \
+   } while (0)
+#define PROFILE_HIST(name, value) \
+   do {                           \
+   } while (0)
+#define PROFILE_REPORT(path) \
+   do {                      \
+   } while (0)
+
+#endif
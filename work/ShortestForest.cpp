@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <functional>
+#include "ShortestForest.hpp"
+#include "Profile.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+// clang-format on
+
+using ll = long long;
+using DistNode = pair<int32_t, int>;  // (始点からの距離, ノード番号)
+
+ShortestForest::ShortestForest(const Graph& graph, int D)
+    : graph_(graph), N_(graph.GetNodeSize()), D_(D), base_dist_(0), stamp_(0) {
+}
+
+void ShortestForest::Init(const vector<int>& edge_day) {
+   const auto& edge_list = graph_.GetEdgeList();
+   int E = edge_list.size();
+
+   dist_.assign((size_t)D_ * N_ * (N_ + 1), (int32_t)DIST_INF);
+   parent_.assign((size_t)D_ * N_ * (N_ + 1), -1);
+
+   day_del_edge_.assign(D_, EdgeBit());
+   day_dist_.assign(D_, 0);
+   day_discon_count_.assign(D_, 0);
+   mark_.assign(N_ + 1, 0);
+
+   rep(e, E) {
+      day_del_edge_[edge_day[e]][e] = 1;
+   }
+
+   base_dist_ = 0;
+
+   for (int s = 1; s <= N_; s++) {
+      base_dist_ += graph_.node_sum_dist_[s];
+   }
+
+   rep(d, D_) {
+      // 全ノードが非連結な状態から始める
+      day_dist_[d] = (ll)N_ * N_ * DIST_INF;
+      day_discon_count_[d] = N_ * N_;
+
+      for (int s = 1; s <= N_; s++) {
+         size_t tree = TreeIndex(d, s);
+
+         SetNode(d, tree, s, 0, -1);
+         heap_.emplace_back(0, s);
+         Relax(d, tree);
+
+         history_.clear();
+      }
+   }
+}
+
+void ShortestForest::SetNode(int d, size_t tree, int node, int dist, int parent) {
+   auto& cur_dist = dist_[tree + node];
+   auto& cur_parent = parent_[tree + node];
+
+   history_.emplace_back(d, tree + node, cur_dist, cur_parent);
+
+   day_dist_[d] += (ll)dist - cur_dist;
+   if (cur_dist == DIST_INF) day_discon_count_[d]--;
+   if (dist == DIST_INF) day_discon_count_[d]++;
+
+   cur_dist = dist;
+   cur_parent = parent;
+}
+
+void ShortestForest::Relax(int d, size_t tree) {
+   const auto& adj_list = graph_.adj_list_;
+   const auto& del_edge = day_del_edge_[d];
+
+   make_heap(heap_.begin(), heap_.end(), greater<DistNode>());
+
+   while (!heap_.empty()) {
+      pop_heap(heap_.begin(), heap_.end(), greater<DistNode>());
+      auto [min_dist, min_node] = heap_.back();
+      heap_.pop_back();
+
+      // すでに更新済みの場合はskip
+      if (dist_[tree + min_node] < min_dist) continue;
+
+      for (const auto& [edge_index, node_to, weight] : adj_list[min_node]) {
+         if (del_edge[edge_index]) continue;
+
+         int32_t next_dist = min_dist + weight;
+
+         if (dist_[tree + node_to] > next_dist) {
+            SetNode(d, tree, node_to, next_dist, min_node);
+
+            heap_.emplace_back(next_dist, node_to);
+            push_heap(heap_.begin(), heap_.end(), greater<DistNode>());
+         }
+      }
+   }
+}
+
+void ShortestForest::AddEdge(int d, int s, int e) {
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+   size_t tree = TreeIndex(d, s);
+
+   auto du = dist_[tree + u];
+   auto dv = dist_[tree + v];
+
+   if (du != DIST_INF && dv > du + w) {
+      SetNode(d, tree, v, du + w, u);
+      heap_.emplace_back(du + w, v);
+   } else if (dv != DIST_INF && du > dv + w) {
+      SetNode(d, tree, u, dv + w, v);
+      heap_.emplace_back(dv + w, u);
+   }
+
+   if (!heap_.empty()) Relax(d, tree);
+}
+
+void ShortestForest::DelEdge(int d, int s, int e) {
+   const auto& adj_list = graph_.adj_list_;
+   const auto& del_edge = day_del_edge_[d];
+
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+   size_t tree = TreeIndex(d, s);
+
+   int child = -1;
+
+   if (parent_[tree + v] == u) child = v;
+   if (parent_[tree + u] == v) child = u;
+
+   if (child == -1) return;  // 最短路木にeが含まれていない
+
+   // 子の部分木を列挙する
+   stamp_++;
+   subtree_.clear();
+
+   mark_[child] = stamp_;
+   stack_.emplace_back(child);
+
+   while (!stack_.empty()) {
+      int node = stack_.back();
+      stack_.pop_back();
+      subtree_.emplace_back(node);
+
+      for (const auto& [edge_index, node_to, weight] : adj_list[node]) {
+         if (del_edge[edge_index]) continue;
+         if (mark_[node_to] == stamp_) continue;
+         if (parent_[tree + node_to] != node) continue;
+
+         mark_[node_to] = stamp_;
+         stack_.emplace_back(node_to);
+      }
+   }
+
+   PROFILE_HIST("ShortestForest::DelEdge.repair_nodes", subtree_.size());
+
+   for (auto node : subtree_) {
+      SetNode(d, tree, node, DIST_INF, -1);
+   }
+
+   // 部分木の外側から距離を確定させる
+   for (auto node : subtree_) {
+      for (const auto& [edge_index, node_to, weight] : adj_list[node]) {
+         if (del_edge[edge_index]) continue;
+         if (mark_[node_to] == stamp_) continue;
+         if (dist_[tree + node_to] == DIST_INF) continue;
+
+         int32_t next_dist = dist_[tree + node_to] + weight;
+
+         if (dist_[tree + node] > next_dist) {
+            SetNode(d, tree, node, next_dist, node_to);
+         }
+      }
+
+      if (dist_[tree + node] != DIST_INF) {
+         heap_.emplace_back(dist_[tree + node], node);
+      }
+   }
+
+   if (!heap_.empty()) Relax(d, tree);
+}
+
+long long ShortestForest::MoveEdge(int e, int from_d, int to_d, bool early_stop) {
+   history_.clear();
+   last_move_ = make_tuple(e, from_d, to_d);
+
+   ll before_from = day_dist_[from_d];
+   ll before_to = day_dist_[to_d];
+
+   day_del_edge_[from_d][e] = 0;
+
+   for (int s = 1; s <= N_; s++) {
+      AddEdge(from_d, s, e);
+   }
+
+   ll gain = before_from - day_dist_[from_d];
+
+   day_del_edge_[to_d][e] = 1;
+
+   for (int s = 1; s <= N_; s++) {
+      DelEdge(to_d, s, e);
+
+      if (early_stop && day_dist_[to_d] - before_to >= gain) break;
+   }
+
+   return gain - (day_dist_[to_d] - before_to);
+}
+
+void ShortestForest::Undo() {
+   auto [e, from_d, to_d] = last_move_;
+
+   for (auto it = history_.rbegin(); it != history_.rend(); ++it) {
+      auto [d, index, dist, parent] = *it;
+
+      day_dist_[d] += (ll)dist - dist_[index];
+      if (dist_[index] == DIST_INF) day_discon_count_[d]--;
+      if (dist == DIST_INF) day_discon_count_[d]++;
+
+      dist_[index] = dist;
+      parent_[index] = parent;
+   }
+
+   history_.clear();
+
+   day_del_edge_[from_d][e] = 1;
+   day_del_edge_[to_d][e] = 0;
+}
+
+long long ShortestForest::CalcDayCost(int d) const {
+   return 1000LL * (day_dist_[d] - base_dist_) / (N_ * (N_ - 1));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include "Graph.hpp"
+
+// 日別・始点別の最短路木(N * D本)を保持し、辺の工事日の変更に対する厳密なコスト差分を求める
+// - 距離は32bit, 親ノードは16bitで保持する(N^2 * D * 6 byte, N=1000, D=30で約180MB)
+// - 辺の追加/削除は影響を受ける部分木のみ再計算する
+class ShortestForest {
+  public:
+   ShortestForest(const Graph& graph, int D);
+
+   // 最短路木を構築する
+   // @param edge_day edge_day[e]: 辺eの工事日(0-indexed)
+   // @pre graph.Prep()を実行済であること
+   void Init(const std::vector<int>& edge_day);
+
+   // 辺eの工事日をfrom_dからto_dに変更し、距離の総和の減少量(正なら改善)を返す
+   // early_stop = trueの場合、to_dでの増加量が改善量以上になった時点で打ち切る
+   // 打ち切った場合は状態が不完全なため必ずUndo()すること
+   long long MoveEdge(int e, int from_d, int to_d, bool early_stop = false);
+
+   // 直前のMoveEdgeを取り消す
+   void Undo();
+
+   // d日目の不満度(Graph::CalcCostと同じスケール)を返す
+   long long CalcDayCost(int d) const;
+
+   // d日目の非連結なノードペア数を返す
+   int GetDayDisconCount(int d) const {
+      return day_discon_count_[d];
+   }
+
+  protected:
+   // (d, s)の最短路木の先頭index
+   size_t TreeIndex(int d, int s) const {
+      return ((size_t)d * N_ + (s - 1)) * (N_ + 1);
+   }
+
+   // 距離と親ノードを更新し、変更履歴を残す
+   void SetNode(int d, size_t tree, int node, int dist, int parent);
+
+   // d日目のsを始点とする最短路木に辺eを追加/削除する
+   // @pre day_del_edge_[d][e]は更新済であること
+   void AddEdge(int d, int s, int e);
+   void DelEdge(int d, int s, int e);
+
+   // heap_に積まれたノードから距離を更新する
+   void Relax(int d, size_t tree);
+
+   const Graph& graph_;
+
+   int N_;  // ノード数
+   int D_;  // スケジュール日数
+
+   std::vector<int32_t> dist_;    // dist_[TreeIndex(d, s) + t]: d日目のsからtへの距離
+   std::vector<int16_t> parent_;  // parent_[TreeIndex(d, s) + t]: d日目のsを始点とする最短路木でのtの親(-1: なし)
+
+   std::vector<EdgeBit> day_del_edge_;      // day_del_edge_[d]: d日目の工事辺
+   std::vector<long long> day_dist_;        // day_dist_[d]: d日目の距離の総和
+   std::vector<int> day_discon_count_;      // day_discon_count_[d]: d日目の非連結なノードペア数
+   long long base_dist_;                    // 工事がない場合の距離の総和
+
+   using History = std::tuple<int, size_t, int32_t, int16_t>;  // 変更履歴(日, index, 変更前の距離, 変更前の親)
+   std::vector<History> history_;
+   std::tuple<int, int, int> last_move_;  // 直前の遷移(辺, 元の工事日, 遷移先の工事日)
+
+   // 作業領域
+   std::vector<std::pair<int32_t, int>> heap_;
+   std::vector<int> stack_;
+   std::vector<int> subtree_;
+   std::vector<int> mark_;
+   int stamp_;
+};
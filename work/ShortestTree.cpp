@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <limits>
 #include <queue>
 #include "ShortestTree.hpp"
+#include "Profile.hpp"
 
 using namespace std;
 
@@ -55,7 +58,8 @@ vector<long long> ShortestPathDijkstra(const vector<vector<Adj>>& adj_list, cons
 
 ShortestTree::ShortestTree(int N)
     : Graph(N), node_(-1), init_dist_(0) {
-   min_dist_tree_.resize(N + 1);
+   min_dist_.resize(N + 1, DIST_INF);
+   parent_.resize(N + 1, -1);
 }
 
 void ShortestTree::Init(int node) {
@@ -63,18 +67,26 @@ void ShortestTree::Init(int node) {
 
    auto min_dist = ShortestPathDijkstra(adj_list_, node);
 
-   auto dfs = [&](auto dfs, int node, int p) -> void {
-      min_dist_tree_[node] = NodeInfo(min_dist[node], p);
+   // 親は距離が一致する隣接ノードのうち隣接リストで先頭のもの
+   for (int n = 1; n <= N_; n++) {
+      parent_[n] = -1;
 
-      for (auto [e, to, w] : adj_list_[node]) {
-         if (to == p) continue;
-         if (min_dist[to] != min_dist[node] + w) continue;
-
-         dfs(dfs, to, node);
+      if (min_dist[n] == numeric_limits<long long>::max()) {
+         min_dist_[n] = DIST_INF;
+         continue;
       }
-   };
 
-   dfs(dfs, node, -1);
+      min_dist_[n] = min_dist[n];
+
+      if (n == node) continue;
+
+      for (auto [e, to, w] : adj_list_[n]) {
+         if (min_dist[to] != numeric_limits<long long>::max() && min_dist[to] + w == min_dist[n]) {
+            parent_[n] = to;
+            break;
+         }
+      }
+   }
 
    init_dist_ = CalcTotalDist();
 }
@@ -85,7 +97,7 @@ void ShortestTree::UpdateMinDistTree(const vector<int>& nodes) {
    priority_queue<WeightNode, vector<WeightNode>, greater<WeightNode>> node_queue;
 
    for (auto n : nodes) {
-      node_queue.emplace(min_dist_tree_[n].first, n);
+      node_queue.emplace(min_dist_[n], n);
    }
 
    while (!node_queue.empty()) {
@@ -95,21 +107,21 @@ void ShortestTree::UpdateMinDistTree(const vector<int>& nodes) {
       // すでに更新済みの場合はskip
       // - skipしないとO(N^2)となるケースが存在
       // see: https://snuke.hatenablog.com/entry/2021/02/22/102734
-      if (min_dist_tree_[min_node].first < min_weight) {
+      if (min_dist_[min_node] < min_weight) {
          continue;
       }
 
-      if (min_dist_tree_[min_node].first == DIST_INF) continue;
+      if (min_dist_[min_node] == DIST_INF) continue;
 
       // 重み最小のノードに隣接するノードを更新できるかチェック
       for (const auto& [edge_index, node_to, weight] : adj_list_[min_node]) {
          if (del_edge_[edge_index]) continue;
 
-         if (min_dist_tree_[node_to].first > min_weight + weight) {
-            min_dist_tree_[node_to].first = min_weight + weight;
-            min_dist_tree_[node_to].second = min_node;
+         if (min_dist_[node_to] > min_weight + weight) {
+            min_dist_[node_to] = min_weight + weight;
+            parent_[node_to] = min_node;
 
-            node_queue.emplace(min_dist_tree_[node_to].first, node_to);
+            node_queue.emplace(min_dist_[node_to], node_to);
          }
       }
    }
@@ -122,22 +134,22 @@ void ShortestTree::AddEdge(int e) {
 
    auto [u, v, w] = edge_list_[e];
 
-   auto du = min_dist_tree_[u].first;
-   auto dv = min_dist_tree_[v].first;
+   auto du = min_dist_[u];
+   auto dv = min_dist_[v];
    vector<int> nodes;
 
-   if (min_dist_tree_[u].first > dv + w) {
+   if (min_dist_[u] > dv + w) {
       nodes.emplace_back(u);
 
-      min_dist_tree_[u].first = dv + w;
-      min_dist_tree_[u].second = v;
+      min_dist_[u] = dv + w;
+      parent_[u] = v;
    }
 
-   if (min_dist_tree_[v].first > du + w) {
+   if (min_dist_[v] > du + w) {
       nodes.emplace_back(v);
 
-      min_dist_tree_[v].first = du + w;
-      min_dist_tree_[v].second = u;
+      min_dist_[v] = du + w;
+      parent_[v] = u;
    }
 
    if (!nodes.empty())
@@ -152,61 +164,51 @@ void ShortestTree::DelEdge(int e) {
    // cerr << e << endl;
    // cerr << "Edges:" << edge_list_.size() << endl;
    auto [u, v, w] = edge_list_[e];
-   int parent = -1, child = -1;
+   int child = -1;
 
-   if (min_dist_tree_[u].first == min_dist_tree_[v].first + w) {
-      parent = v;
-      child = u;
-   }
-
-   if (min_dist_tree_[v].first == min_dist_tree_[u].first + w) {
-      parent = u;
-      child = v;
-   }
+   if (parent_[u] == v) child = u;
+   if (parent_[v] == u) child = v;
 
-   if (parent == -1) return;  // 最短路木にeが含まれていない
+   if (child == -1) return;  // 最短路木にeが含まれていない
 
-   set<int> node_set;
+   // 子の部分木を親ポインタでたどってクリアする
+   // 部分木と隣接するノードを距離の更新の始点にする
+   vector<int> nodes;
+   vector<int> stack{child};
 
-   // 子の最短路木をクリアする
-   auto dfs = [&](auto dfs, int node, int p) -> void {
-      auto cur_dist = min_dist_tree_[node].first;
+   while (!stack.empty()) {
+      int node = stack.back();
+      stack.pop_back();
 
-      min_dist_tree_[node] = NodeInfo(DIST_INF, -1);
+      min_dist_[node] = DIST_INF;
+      parent_[node] = -1;
 
-      node_set.insert(node);
+      nodes.emplace_back(node);
 
       for (auto [e, to, w] : adj_list_[node]) {
          if (del_edge_[e]) continue;
-         node_set.insert(to);
-
-         if (to == p) continue;
-
-         if (min_dist_tree_[to].first != cur_dist + w) continue;
 
-         dfs(dfs, to, node);
+         if (parent_[to] == node) {
+            stack.emplace_back(to);
+         } else {
+            nodes.emplace_back(to);
+         }
       }
-   };
-
-   dfs(dfs, child, parent);
-
-   if (node_set.empty()) return;
-
-   vector<int> nodes;
-
-   for (auto n : node_set) {
-      nodes.emplace_back(n);
    }
 
+   sort(nodes.begin(), nodes.end());
+   nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+   PROFILE_HIST("ShortestTree::DelEdge.repair_nodes", nodes.size());
+
    UpdateMinDistTree(nodes);
-   return;
 }
 
 long long ShortestTree::CalcTotalDist() const {
    long long dist = 0;
 
+   // 距離は32bitなので連続領域の総和はベクトル化される
    for (int i = 1; i <= N_; i++) {
-      dist += min_dist_tree_[i].first;
+      dist += min_dist_[i];
    }
 
    dist = 1000LL * dist;
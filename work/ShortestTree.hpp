@@ -1,11 +1,11 @@
 #pragma once
 
 #include <map>
+#include <cstdint>
 #include "Graph.hpp"
 
 // nodeを始点とする最短路木を管理する
-using NodeInfo = std::pair<long long, int>;  // dist, parent
-
+// 距離と親ノードは別配列で持つ(距離の走査で親ノードを読まないようにする)
 class ShortestTree
     : public Graph {
   public:
@@ -26,6 +26,7 @@ class ShortestTree
 
    int node_;
    long long init_dist_;
-   EdgeBit del_edge_;                     // 削除した辺フラグ
-   std::vector<NodeInfo> min_dist_tree_;  // node_を始点とする最短路(node_からの距離, 親ノード)を記録する
+   EdgeBit del_edge_;              // 削除した辺フラグ
+   std::vector<int32_t> min_dist_;  // min_dist_[n]: node_からnへの最短距離
+   std::vector<int32_t> parent_;    // parent_[n]: 最短路木でのnの親ノード
 };
\ No newline at end of file
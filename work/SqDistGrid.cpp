@@ -0,0 +1,113 @@
+#include <cmath>
+#include <algorithm>
+#include "SqDistGrid.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+
+template<class T> bool chmax(T &a, const T &b) {if(a<b) {a=b; return true;} return false; }
+template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} return false; }
+// clang-format on
+
+using ll = long long;
+
+SqDistGrid::SqDistGrid(const Graph& graph)
+    : graph_(graph) {
+   int N = graph.GetNodeSize();
+   int max_coord = 0;
+
+   for (int u = 1; u <= N; u++) {
+      auto [x, y] = graph.GetNodeCoord(u);
+      chmax(max_coord, max(x, y));
+   }
+
+   // 1セルあたり平均1ノード程度になるように分割する
+   cell_num_ = max(1, (int)sqrt(N));
+   cell_size_ = max_coord / cell_num_ + 1;
+
+   cell_node_.resize(cell_num_ * cell_num_);
+   selected_.resize(N + 1, 0);
+}
+
+void SqDistGrid::Clear() {
+   for (auto u : selected_node_) {
+      auto [x, y] = graph_.GetNodeCoord(u);
+      cell_node_[CellIndex(y) * cell_num_ + CellIndex(x)].clear();
+      selected_[u] = 0;
+   }
+
+   selected_node_.clear();
+}
+
+void SqDistGrid::AddEdge(int e) {
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+
+   for (auto node : {u, v}) {
+      if (selected_[node]) continue;
+
+      auto [x, y] = graph_.GetNodeCoord(node);
+
+      selected_[node] = 1;
+      selected_node_.emplace_back(node);
+      cell_node_[CellIndex(y) * cell_num_ + CellIndex(x)].emplace_back(node);
+   }
+}
+
+ll SqDistGrid::NodeMinSqDist(Node u) const {
+   ll min_dist = DIST_INF;
+
+   if (selected_node_.empty()) return min_dist;
+
+   auto [x, y] = graph_.GetNodeCoord(u);
+   int cx = CellIndex(x);
+   int cy = CellIndex(y);
+
+   // uのセルからチェビシェフ距離rのセルを順に調べる
+   // r + 1以降のセルの点はuから(r * cell_size_)より遠いため、それ以下の点が見つかれば打ち切る
+   for (int r = 0; r < cell_num_; r++) {
+      for (int ny = max(0, cy - r); ny <= min(cell_num_ - 1, cy + r); ny++) {
+         bool edge_row = (ny == cy - r || ny == cy + r);
+         int step = edge_row ? 1 : 2 * r;
+
+         for (int nx = cx - r; nx <= cx + r; nx += step) {
+            if (nx < 0 || nx >= cell_num_) continue;
+
+            for (auto node : cell_node_[ny * cell_num_ + nx]) {
+               chmin(min_dist, graph_.CalcNodeSqDist(u, node));
+            }
+         }
+      }
+
+      ll bound = (ll)r * cell_size_;
+
+      if (min_dist <= bound * bound) break;
+   }
+
+   return min_dist;
+}
+
+void SqDistGrid::NodesInRange(Node u, ll sq_radius, vector<Node>& nodes) const {
+   auto [x, y] = graph_.GetNodeCoord(u);
+   int radius = (int)sqrt((double)sq_radius) + 1;
+
+   int min_cx = max(0, CellIndex(max(0, x - radius)));
+   int max_cx = min(cell_num_ - 1, CellIndex(x + radius));
+   int min_cy = max(0, CellIndex(max(0, y - radius)));
+   int max_cy = min(cell_num_ - 1, CellIndex(y + radius));
+
+   for (int cy = min_cy; cy <= max_cy; cy++) {
+      for (int cx = min_cx; cx <= max_cx; cx++) {
+         for (auto node : cell_node_[cy * cell_num_ + cx]) {
+            if (graph_.CalcNodeSqDist(u, node) <= sq_radius) nodes.emplace_back(node);
+         }
+      }
+   }
+}
+
+ll SqDistGrid::EdgeMinSqDist(int e) const {
+   auto [u, v, w] = graph_.GetEdgeList()[e];
+
+   return min(NodeMinSqDist(u), NodeMinSqDist(v));
+}
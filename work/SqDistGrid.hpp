@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include "Graph.hpp"
+
+// 選択した辺の端点を一様グリッドで管理し、選択済の辺集合との平方距離の最小値を求める
+// - 辺同士の平方距離はGraph::CalcEdgeSqDistと同じく端点間の平方距離の最小値とする
+// - メモリ: O(N + セル数)
+class SqDistGrid {
+  public:
+   SqDistGrid(const Graph& graph);
+
+   // 選択済の辺集合を空にする
+   // 計算量: O(選択済のノード数)
+   void Clear();
+
+   // 辺eを選択済にする
+   // 計算量: O(1)
+   void AddEdge(int e);
+
+   // ノードuと選択済の辺の端点との平方距離の最小値を返す(選択済の辺がない場合はDIST_INF)
+   // 計算量: O(最近点までのセル数 + 走査した点数)
+   long long NodeMinSqDist(Node u) const;
+
+   // 辺eと選択済の辺との平方距離の最小値を返す
+   long long EdgeMinSqDist(int e) const;
+
+   // ノードuとの平方距離がsq_radius以下の選択済のノードをnodesに追加する
+   // 計算量: O(半径内のセル数 + 走査した点数)
+   void NodesInRange(Node u, long long sq_radius, std::vector<Node>& nodes) const;
+
+  protected:
+   // 座標のセル番号
+   int CellIndex(int c) const {
+      return c / cell_size_;
+   }
+
+   const Graph& graph_;
+
+   int cell_size_;  // セルの一辺の長さ
+   int cell_num_;   // 一辺あたりのセル数
+
+   std::vector<std::vector<Node>> cell_node_;  // cell_node_[cy * cell_num_ + cx]: セルに含まれる選択済のノード
+   std::vector<char> selected_;               // selected_[u]: ノードuが選択済の辺の端点か
+   std::vector<Node> selected_node_;          // 選択済のノード
+};
@@ -1,6 +1,10 @@
 #include <numeric>
+#include <queue>
+#include <thread>
+#include <atomic>
 #include "SqDistScheduler.hpp"
 #include "UnionFind.hpp"
+#include "SqDistGrid.hpp"
 
 using namespace std;
 
@@ -14,11 +18,11 @@ template<class T> bool chmin(T &a, const T &b) {if(a>b) {a=b; return true;} retu
 using ll = long long;
 
 SqDistScheduler::SqDistScheduler(int N, int D, int K)
-    : Graph(N), D_(D), K_(K) {
+    : Graph(N), D_(D), K_(K), thread_num_(0), union_find_(N) {
 }
 
 void SqDistScheduler::MakeSchedule(const vector<EdgeBit> &day_avail_edge_bit) {
-   Prep();
+   Prep(true);
 
    int M = edge_list_.size();
    schedule_.resize(M);
@@ -42,20 +46,71 @@ void SqDistScheduler::MakeSchedule(const vector<EdgeBit> &day_avail_edge_bit) {
       return e_list;
    };
 
-   vector<vector<ll>> dist_tbl(M, vector<ll>(M, 0));
+   // 工事計画に追加した辺との平方距離
+   SqDistGrid plan_grid(*this);
+   SqDistGrid cand_grid(*this);  // 工事計画の候補となる辺の端点
 
-   rep(i, M) rep(j, M) {
-      auto edge_1 = edge_list_[i];
-      auto edge_2 = edge_list_[j];
+   static constexpr ll kBypassBaseLine = 5 * 1000000;
 
-      dist_tbl[i][j] = CalcEdgeSqDist(edge_1, edge_2);
-   }
+   // raw_min_dist[e]: 辺eと工事計画に追加した辺との平方距離の最小値
+   // 工事計画に辺を追加するたびに減少のみするため、遅延評価のmax heapで最大値を管理する
+   vector<ll> raw_min_dist(M, DIST_INF);
+   vector<char> is_cand(M, 0);
+
+   using DistEdge = pair<ll, int>;
+   priority_queue<DistEdge> key_heap;  // (下駄込みの距離, -edge index): 同距離ならedge indexが小さい辺を優先する
+   priority_queue<DistEdge> raw_heap;  // (raw_min_dist, edge index): 更新対象の半径を求める
+   vector<Node> range_node;
+
+   // 迂回路を通らない場合を優先するために下駄を履かせる
+   auto calc_key = [&](int e, const EdgeBit &bypass_bit) {
+      return raw_min_dist[e] + (bypass_bit[e] ? 0 : kBypassBaseLine);
+   };
+
+   auto push_cand = [&](int e, const EdgeBit &bypass_bit) {
+      key_heap.emplace(calc_key(e, bypass_bit), -e);
+      raw_heap.emplace(raw_min_dist[e], e);
+   };
 
    // 辺を工事計画に追加する
    auto add_edge_to_plan = [&](int e, vector<int> &plan_edge_index, EdgeBit &bypass_bit) {
       constructed[e] = true;
       plan_edge_index.emplace_back(e);
-      bypass_bit = bypass_bit | edge_bypass_[e];
+      plan_grid.AddEdge(e);
+
+      // 新たに迂回路に入った候補は下駄がなくなる
+      EdgeBit new_bypass_bit = edge_bypass_[e] & ~bypass_bit;
+      bypass_bit |= edge_bypass_[e];
+
+      for (int f = new_bypass_bit._Find_first(); f < M; f = new_bypass_bit._Find_next(f)) {
+         if (is_cand[f] && !constructed[f]) push_cand(f, bypass_bit);
+      }
+
+      // 候補の距離の最大値(raw_heapの先頭)以下の範囲にある候補のみ距離が減少しうる
+      while (!raw_heap.empty()) {
+         auto [dist, f] = raw_heap.top();
+         if (!constructed[f] && dist == raw_min_dist[f]) break;
+         raw_heap.pop();
+      }
+
+      if (raw_heap.empty()) return;
+
+      ll sq_radius = raw_heap.top().first;
+      auto [u, v, w] = edge_list_[e];
+
+      range_node.clear();
+      cand_grid.NodesInRange(u, sq_radius, range_node);
+      cand_grid.NodesInRange(v, sq_radius, range_node);
+
+      for (auto node : range_node) {
+         for (const auto &[f, node_to, weight] : adj_list_[node]) {
+            if (!is_cand[f] || constructed[f]) continue;
+
+            if (chmin(raw_min_dist[f], CalcEdgeSqDist(edge_list_[f], edge_list_[e]))) {
+               push_cand(f, bypass_bit);
+            }
+         }
+      }
    };
 
    // 未工事の辺
@@ -65,6 +120,12 @@ void SqDistScheduler::MakeSchedule(const vector<EdgeBit> &day_avail_edge_bit) {
       vector<int> plan_edge_index;
       EdgeBit bypass_bit;
 
+      plan_grid.Clear();
+      cand_grid.Clear();
+      fill(is_cand.begin(), is_cand.end(), 0);
+      key_heap = priority_queue<DistEdge>();
+      raw_heap = priority_queue<DistEdge>();
+
       if ((int)edge_index_list.size() <= E) {
          // 残りをすべて工事できる場合
          for (auto e : edge_index_list) {
@@ -96,56 +157,95 @@ void SqDistScheduler::MakeSchedule(const vector<EdgeBit> &day_avail_edge_bit) {
          add_edge_to_plan(e, plan_edge_index, bypass_bit);
       }
 
-      while ((int)plan_edge_index.size() < E) {
-         int ne = -1;
-         ll max_min_dist = -1;
-
-         for (auto e : edge_index_list) {
-            if (constructed[e]) continue;
+      // 候補の距離を初期化する
+      for (auto e : edge_index_list) {
+         if (constructed[e]) continue;
 
-            ll min_dist = DIST_INF;
-            static constexpr ll kBypassBaseLine = 5 * 1000000;
+         is_cand[e] = 1;
+         cand_grid.AddEdge(e);
+         raw_min_dist[e] = plan_grid.EdgeMinSqDist(e);
+         push_cand(e, bypass_bit);
+      }
 
-            for (auto plan_edge : plan_edge_index) {
-               auto dist = dist_tbl[e][plan_edge];
+      // 工事計画の辺から最も遠い候補を順に追加する
+      // 計算量: O(M log M + 追加した辺の近傍の候補数 * log M)
+      while ((int)plan_edge_index.size() < E) {
+         auto [key, neg_e] = key_heap.top();
+         key_heap.pop();
 
-               // 迂回路を通らない場合を優先するために下駄を履かせる
-               if (!bypass_bit[e]) dist += kBypassBaseLine;
+         int e = -neg_e;
 
-               chmin(min_dist, dist);
-            }
+         if (constructed[e]) continue;
 
-            if (chmax(max_min_dist, min_dist)) {
-               ne = e;
-            }
+         if (key != calc_key(e, bypass_bit)) {
+            // 距離が古い場合は積み直す(距離は減少のみのため先頭が最新なら最大)
+            key_heap.emplace(calc_key(e, bypass_bit), -e);
+            continue;
          }
 
-         add_edge_to_plan(ne, plan_edge_index, bypass_bit);
+         add_edge_to_plan(e, plan_edge_index, bypass_bit);
       }
 
       return plan_edge_index;
    };
 
+   // 辺の選択は前日までの工事済の辺に依存するため逐次に行う
+   vector<vector<int>> day_edge_list(D_);
+
    rep(d, D_) {
       // 未工事の枝を1つ決める
-      auto construct_edge_index = calc_construct_edge(d);
+      day_edge_list[d] = calc_construct_edge(d);
 
-      for (auto e : construct_edge_index) {
+      for (auto e : day_edge_list[d]) {
          schedule_[e] = d + 1;
       }
-
-      auto [cost, discon_count] = CalcCost(construct_edge_index);
-
-      daily_cost_[d] = cost;
-      daily_discon_count_[d] = discon_count;
    }
 
+   EvalDailyCost(day_edge_list);
+
    // debug(daily_cost_);
    // debug(daily_discon_count_);
 }
 
+void SqDistScheduler::EvalDailyCost(const vector<vector<int>> &day_edge_list) {
+   daily_edge_count_.resize(D_);
+
+   rep(d, D_) {
+      daily_edge_count_[d] = day_edge_list[d].size();
+   }
+
+   int thread_num = thread_num_ > 0 ? thread_num_ : (int)thread::hardware_concurrency();
+   thread_num = max(1, min(thread_num, D_));
+
+   // 日ごとに独立なのでスレッドが空き次第、次の日を評価する
+   atomic<int> next_day(0);
+
+   auto worker = [&]() {
+      for (int d = next_day++; d < D_; d = next_day++) {
+         auto [cost, discon_count] = CalcCost(day_edge_list[d]);
+
+         daily_cost_[d] = cost;
+         daily_discon_count_[d] = discon_count;
+      }
+   };
+
+   vector<thread> thread_list;
+
+   rep(i, thread_num - 1) {
+      thread_list.emplace_back(worker);
+   }
+
+   worker();
+
+   for (auto &th : thread_list) {
+      th.join();
+   }
+}
+
 EdgeBit SqDistScheduler::CalcAvailEdgeWithConnection(int d, const EdgeBit &constructed_edge) const {
-   UnionFind uf(N_);
+   auto &uf = union_find_;
+   uf.Reset();
+
    EdgeBit avail_bit;
 
    int remain_day = D_ - d;
@@ -188,3 +288,13 @@ int SqDistScheduler::CalcScheduleDisconCount() const {
    ll sum_count = accumulate(daily_discon_count_.begin(), daily_discon_count_.end(), 0);
    return sum_count;
 }
+
+vector<DailyReport> SqDistScheduler::GetDailyReport() const {
+   vector<DailyReport> report(D_);
+
+   rep(d, D_) {
+      report[d] = {d + 1, daily_edge_count_[d], daily_cost_[d], daily_discon_count_[d]};
+   }
+
+   return report;
+}
@@ -1,5 +1,14 @@
 // 平方距離に基づく辺選択を行う
 #include "Graph.hpp"
+#include "UnionFind.hpp"
+
+// 日別の評価結果
+struct DailyReport {
+   int day;           // 工事日(1-indexed)
+   int edge_count;    // 工事する辺数
+   long long cost;    // 不満度
+   int discon_count;  // 非連結なノードペア数
+};
 
 class SqDistScheduler
     : public Graph {
@@ -14,14 +23,30 @@ class SqDistScheduler
    long long CalcScheduleCost() const;
    int CalcScheduleDisconCount() const;
 
+   // 日別の評価結果を返す
+   std::vector<DailyReport> GetDailyReport() const;
+
+   // 日別のコスト評価に使うスレッド数を設定する(0: ハードウェアのスレッド数)
+   void SetThreadNum(int thread_num) {
+      thread_num_ = thread_num;
+   }
+
   protected:
    // 連結性を保てる工事可能な辺集合を返す
    EdgeBit CalcAvailEdgeWithConnection(int d, const EdgeBit& constructed_edge) const;
 
+   // 日別のコストを並列に評価する
+   void EvalDailyCost(const std::vector<std::vector<int>>& day_edge_list);
+
    int D_;  // スケジュール日数
    int K_;  // 最大の変数
 
+   int thread_num_;  // 日別のコスト評価に使うスレッド数
+
    std::vector<int> schedule_;            // schedule_[i]: i番目の辺の工事日
    std::vector<long long> daily_cost_;    // 日別の不満度
    std::vector<int> daily_discon_count_;  // 日別の非連結なノードペア数
+   std::vector<int> daily_edge_count_;    // 日別の工事する辺数
+
+   mutable UnionFind union_find_;  // CalcAvailEdgeWithConnectionの作業領域
 };
@@ -2,41 +2,74 @@
 
 #include <vector>
 #include <map>
+#include <cstddef>
+#include <cstdint>
 
-namespace std {
 // UnionFindで素集合を管理するクラス
 // ノードIDは1-indexed
+// - Union by sizeのみで経路圧縮は行わない(Rollbackで結合を取り消せるようにするため)
+// - Resetは世代番号の更新のみで行い、次に触れたノードから初期化する
 class UnionFind {
   public:
    UnionFind(const size_t N);
 
+   // 全ノードを独立した集合に戻す
+   // 計算量: O(1)
+   void Reset();
+
    // node_1とnode_2が所属する集合を結合する(Union by size)
-   // 計算量: O(almost 1)
-   void Unite(size_t node_1, size_t node_2);
+   // 結合した場合はtrueを返す
+   // 計算量: O(log N)
+   bool Unite(int node_1, int node_2);
 
    // node_1とnode_2が同じ集合に入っているか
-   // 計算量: O(almost 1)
-   bool IsSameGroup(size_t node_1, size_t node_2) const;
+   // 計算量: O(log N)
+   bool IsSameGroup(int node_1, int node_2) const;
 
    // nodeが所属する集合のサイズを返す
-   // 計算量: O(almost 1)
-   size_t size(size_t node) const;
+   // 計算量: O(log N)
+   int size(int node) const;
+
+   // 集合の数を返す
+   int GroupCount() const {
+      return group_count_;
+   }
 
    // 各グループを返す(親ノードの番号 -> 子のリスト)
-   map<size_t, vector<size_t>> EnumGroup() const;
+   std::map<int, std::vector<int>> EnumGroup() const;
 
    // nodeの親のnode_idを返す
-   size_t root(size_t node) const;
+   int root(int node) const;
+
+   // 現在の状態を表す値を返す(Rollbackに渡す)
+   size_t Snapshot() const {
+      return history_.size();
+   }
+
+   // Snapshotを取得した時点まで結合を取り消す
+   // 計算量: O(取り消す結合の数)
+   void Rollback(size_t snapshot);
 
   private:
+   // 世代が古いノードを初期化する
+   void Touch(int node) const;
+
    // ノードの数
-   size_t N_;
+   int N_;
+
+   // 集合の数
+   int group_count_;
 
-   // parent_node_id_[i]: 親ノードのノードID, rootの場合はparent_node_id_[i] ==
-   // iになる
-   mutable vector<size_t> parent_node_id_;
+   // parent_node_id_[i]: 親ノードのノードID, rootの場合はparent_node_id_[i] == iになる
+   mutable std::vector<int32_t> parent_node_id_;
 
    // tree_size_[i]: ルートノードiに含まれる集合のサイズ
-   vector<size_t> tree_size_;
+   mutable std::vector<int32_t> tree_size_;
+
+   // generation_[i]: ノードiの値が有効な世代
+   mutable std::vector<uint32_t> generation_;
+   uint32_t cur_generation_;
+
+   // 結合の履歴(子にしたルートノード)
+   std::vector<int32_t> history_;
 };
-}  // namespace std
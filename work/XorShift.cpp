@@ -1,9 +1,13 @@
 #include "XorShift.hpp"
 
-unsigned int XorShift() {
-   // ref: https://qiita.com/drken/items/7c6ff2aa4d8fce1c9361#9-xorshift
-   static unsigned int tx = 123456789, ty = 362436069, tz = 521288629, tw = 88675123;
+namespace {
+// ref: https://qiita.com/drken/items/7c6ff2aa4d8fce1c9361#9-xorshift
+constexpr unsigned int kInitX = 123456789, kInitY = 362436069, kInitZ = 521288629, kInitW = 88675123;
+
+thread_local unsigned int tx = kInitX, ty = kInitY, tz = kInitZ, tw = kInitW;
+}  // namespace
 
+unsigned int XorShift() {
    unsigned int tt = (tx ^ (tx << 11));
 
    tx = ty;
@@ -11,4 +15,11 @@ unsigned int XorShift() {
    tz = tw;
 
    return (tw = (tw ^ (tw >> 19)) ^ (tt ^ (tt >> 8)));
-}
\ No newline at end of file
+}
+
+void ResetXorShift() {
+   tx = kInitX;
+   ty = kInitY;
+   tz = kInitZ;
+   tw = kInitW;
+}
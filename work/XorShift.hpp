@@ -1,4 +1,8 @@
 #pragma once
 
 // XorShift法による乱数生成
-unsigned int XorShift();
\ No newline at end of file
+// 状態はスレッドごとに持つ(複数ケースを並列に実行しても互いに影響しない)
+unsigned int XorShift();
+
+// 呼び出したスレッドの乱数の状態を初期値に戻す
+void ResetXorShift();
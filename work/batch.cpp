@@ -0,0 +1,308 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "XorShift.hpp"
+#include "Graph.hpp"
+#include "FaceGroup.hpp"
+#include "FaceGroupSchedulerExp.hpp"
+#include "Profile.hpp"
+
+using namespace std;
+
+// clang-format off
+#define rep(i, n) for (int i = 0; (i) < (int)(n); (i)++)
+// clang-format on
+
+using ll = long long;
+
+// 複数の入力ファイルを1プロセスで評価する
+// 使い方: ./batch [-j スレッド数] [-o 出力ファイル] [-t 制限時間(ms)] [--exact] [-l 入力リスト] 入力ファイル/ディレクトリ...
+// - ディレクトリは直下のファイルを名前順に評価する
+// - 出力ファイルの拡張子が.jsonlの場合はJSONL、それ以外はCSV(-o省略時は標準出力にCSV)
+// - 行はケースの評価が終わった順に出力する(indexは入力順)
+// - 制限時間はスケジューラ生成からの経過時間(省略時はmainと同じ)
+//   スレッド数がコア数を超えると1ケースあたりの計算時間が減るため注意
+struct BatchOption {
+   int thread_num = 1;
+   int time_limit_ms = 0;
+   bool exact_eval = false;
+   string output_path;
+   vector<string> input_list;
+};
+
+struct CaseResult {
+   int index;
+   string path;
+   int N, M, D, K;
+   ll cost;
+   int discon_cnt;
+   int over_k;
+   int iter;
+   double read_ms;      // 入力の読み込み
+   double group_ms;     // 前処理と面集合の生成
+   double schedule_ms;  // スケジューリング
+   double eval_ms;      // スケジュールのコスト計算
+};
+
+// 入力ファイルを読み込む(ファイル全体を読んでから整数を切り出す)
+static bool ReadInput(const string& path, vector<ll>& value_list) {
+   ifstream ifs(path, ios::binary);
+   if (!ifs) return false;
+
+   stringstream ss;
+   ss << ifs.rdbuf();
+   const string buf = ss.str();
+
+   value_list.clear();
+   const char* p = buf.c_str();
+
+   while (*p) {
+      while (*p && (*p < '0' || *p > '9') && *p != '-') p++;
+      if (!*p) break;
+
+      char* end;
+      value_list.emplace_back(strtoll(p, &end, 10));
+      p = end;
+   }
+
+   return true;
+}
+
+static CaseResult RunCase(int index, const string& path, const BatchOption& option) {
+   using Clock = chrono::steady_clock;
+   auto elapsed_ms = [](Clock::time_point from, Clock::time_point to) {
+      return chrono::duration<double, milli>(to - from).count();
+   };
+
+   CaseResult result{index, path, 0, 0, 0, 0, -1, -1, -1, 0, 0, 0, 0, 0};
+
+   // 乱数はスレッドごとなので、ケースごとに初期化して実行順に依存しないようにする
+   ResetXorShift();
+
+   auto t0 = Clock::now();
+   vector<ll> value_list;
+
+   if (!ReadInput(path, value_list) || value_list.size() < 4) {
+      return result;
+   }
+
+   int N = value_list[0], M = value_list[1], D = value_list[2], K = value_list[3];
+
+   if ((int)value_list.size() < 4 + 3 * M + 2 * N) {
+      return result;
+   }
+
+   result.N = N, result.M = M, result.D = D, result.K = K;
+
+   FaceGroup face_group(N, D);
+   int pos = 4;
+
+   rep(i, M) {
+      face_group.AddEdge(value_list[pos], value_list[pos + 1], value_list[pos + 2]);
+      pos += 3;
+   }
+
+   rep(i, N) {
+      face_group.SetNodeCoord(i + 1, value_list[pos], value_list[pos + 1]);
+      pos += 2;
+   }
+
+   auto t1 = Clock::now();
+   auto face_group_list = face_group.MakeGroup();
+   auto t2 = Clock::now();
+
+   FaceGroupSchedulerExp scheduler(M, D, K, face_group, face_group_list);
+   scheduler.SetExactEval(option.exact_eval);
+   scheduler.SetTimeLimit(option.time_limit_ms);
+
+   auto schedule = scheduler.MakeSchedule(10000);
+   auto t3 = Clock::now();
+
+   ll cost = 0;
+   int discon_cnt = 0;
+
+   {
+      PROFILE_SCOPE("Graph::CalcScheduleCost");
+      tie(cost, discon_cnt) = face_group.CalcScheduleCost(D, schedule);
+   }
+
+   auto t4 = Clock::now();
+
+   result.cost = cost;
+   result.discon_cnt = discon_cnt;
+   result.over_k = CalcOverK(K, schedule);
+   result.iter = scheduler.GetIterCount();
+   result.read_ms = elapsed_ms(t0, t1);
+   result.group_ms = elapsed_ms(t1, t2);
+   result.schedule_ms = elapsed_ms(t2, t3);
+   result.eval_ms = elapsed_ms(t3, t4);
+
+   return result;
+}
+
+static string FormatResult(const CaseResult& r, bool jsonl) {
+   ostringstream os;
+   os.precision(1);
+   os << fixed;
+
+   if (jsonl) {
+      // パスはJSON文字列としてエスケープする
+      string path;
+
+      for (char c : r.path) {
+         if (c == '"' || c == '\\') path += '\\';
+         path += c;
+      }
+
+      os << "{\"index\":" << r.index << ",\"path\":\"" << path << "\""
+         << ",\"N\":" << r.N << ",\"M\":" << r.M << ",\"D\":" << r.D << ",\"K\":" << r.K
+         << ",\"cost\":" << r.cost << ",\"discon_cnt\":" << r.discon_cnt << ",\"over_k\":" << r.over_k << ",\"iter\":" << r.iter
+         << ",\"read_ms\":" << r.read_ms << ",\"group_ms\":" << r.group_ms << ",\"schedule_ms\":" << r.schedule_ms << ",\"eval_ms\":" << r.eval_ms << "}";
+   } else {
+      // パスはダブルクォートで囲み、パス中のダブルクォートは2つ重ねる(RFC 4180)
+      string path;
+
+      for (char c : r.path) {
+         if (c == '"') path += '"';
+         path += c;
+      }
+
+      os << r.index << ",\"" << path << "\"," << r.N << ',' << r.M << ',' << r.D << ',' << r.K << ','
+         << r.cost << ',' << r.discon_cnt << ',' << r.over_k << ',' << r.iter << ','
+         << r.read_ms << ',' << r.group_ms << ',' << r.schedule_ms << ',' << r.eval_ms;
+   }
+
+   return os.str();
+}
+
+static bool ParseOption(int argc, char* argv[], BatchOption& option) {
+   vector<string> arg_list;
+
+   for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "-j" && i + 1 < argc) {
+         option.thread_num = max(1, stoi(argv[++i]));
+      } else if (arg == "-o" && i + 1 < argc) {
+         option.output_path = argv[++i];
+      } else if (arg == "-t" && i + 1 < argc) {
+         option.time_limit_ms = stoi(argv[++i]);
+      } else if (arg == "--exact") {
+         option.exact_eval = true;
+      } else if (arg == "-l" && i + 1 < argc) {
+         ifstream ifs(argv[++i]);
+         if (!ifs) return false;
+
+         string path;
+
+         while (ifs >> path) {
+            arg_list.emplace_back(path);
+         }
+      } else {
+         arg_list.emplace_back(arg);
+      }
+   }
+
+   namespace fs = std::filesystem;
+
+   for (const auto& arg : arg_list) {
+      if (fs::is_directory(arg)) {
+         vector<string> file_list;
+
+         for (const auto& entry : fs::directory_iterator(arg)) {
+            if (entry.is_regular_file()) file_list.emplace_back(entry.path().string());
+         }
+
+         sort(file_list.begin(), file_list.end());
+         option.input_list.insert(option.input_list.end(), file_list.begin(), file_list.end());
+      } else {
+         option.input_list.emplace_back(arg);
+      }
+   }
+
+   return !option.input_list.empty();
+}
+
+int main(int argc, char* argv[]) {
+   BatchOption option;
+
+   if (!ParseOption(argc, argv, option)) {
+      cerr << "usage: " << argv[0] << " [-j threads] [-o out.csv|out.jsonl] [-t time_limit_ms] [--exact] [-l list] inputs..." << endl;
+      return 1;
+   }
+
+   ofstream ofs;
+
+   if (!option.output_path.empty()) {
+      ofs.open(option.output_path);
+
+      if (!ofs) {
+         cerr << "cannot open " << option.output_path << endl;
+         return 1;
+      }
+   }
+
+   ostream& os = option.output_path.empty() ? cout : ofs;
+   const string ext = ".jsonl";
+   const auto& path = option.output_path;
+   bool jsonl = path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+
+   if (!jsonl) {
+      os << "index,path,N,M,D,K,cost,discon_cnt,over_k,iter,read_ms,group_ms,schedule_ms,eval_ms" << endl;
+   }
+
+   int case_num = option.input_list.size();
+   int thread_num = min(option.thread_num, case_num);
+
+   atomic<int> next_case(0);
+   mutex output_mutex;
+   ll sum_cost = 0;
+   int fail_count = 0;
+
+   auto worker = [&]() {
+      for (int i = next_case++; i < case_num; i = next_case++) {
+         auto result = RunCase(i, option.input_list[i], option);
+
+         lock_guard<mutex> lock(output_mutex);
+
+         if (result.cost < 0) {
+            cerr << "failed to read " << result.path << endl;
+            fail_count++;
+            continue;
+         }
+
+         sum_cost += result.cost;
+
+         // 途中で止めても結果が残るように1行ずつ書き出す
+         os << FormatResult(result, jsonl) << endl;
+      }
+   };
+
+   vector<thread> thread_list;
+
+   rep(i, thread_num - 1) {
+      thread_list.emplace_back(worker);
+   }
+
+   worker();
+
+   for (auto& th : thread_list) {
+      th.join();
+   }
+
+   // 全ケースの合計
+   PROFILE_REPORT("profile.json");
+
+   cerr << "Cases=" << case_num - fail_count << " Failed=" << fail_count << " SumCost=" << sum_cost << endl;
+
+   return fail_count == 0 ? 0 : 1;
+}
@@ -7,6 +7,7 @@
 #include "FaceGroup.hpp"
 #include "FaceGroupSchedulerExp.hpp"
 #include "DualGraph.hpp"
+#include "Profile.hpp"
 
 using namespace std;
 
@@ -47,7 +48,14 @@ int main() {
    cout << schedule << endl;
 
 #ifdef LOCAL
-   auto [sche_cost, sche_discon_cnt] = face_group.CalcScheduleCost(D, schedule);
+   long long sche_cost = 0;
+   int sche_discon_cnt = 0;
+
+   {
+      PROFILE_SCOPE("Graph::CalcScheduleCost");
+      tie(sche_cost, sche_discon_cnt) = face_group.CalcScheduleCost(D, schedule);
+   }
+
    // int sche_cost = 0, sche_discon_cnt = 0;
    cerr
        << "Cost=" << sche_cost << ' ';
@@ -58,5 +66,7 @@ int main() {
    cerr << endl;
 #endif
 
+   PROFILE_REPORT("profile.json");
+
    return 0;
 }